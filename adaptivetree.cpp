@@ -0,0 +1,299 @@
+/*****************************************************************************/
+/* File: adaptivetree.cpp                                                    */
+/* Description:                                                              */
+/*   Contains the implementation details for an adaptive branching tree     */
+/*   class that switches node selection strategies during the search.       */
+/*****************************************************************************/
+#include "state.h"
+#include "btree.h"
+#include "adaptivetree.h"
+#include "util.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+/*****************************************************************************/
+/* AdaptiveTree constructor, destructor, and initialization functions        */
+/*****************************************************************************/
+AdaptiveTree::AdaptiveTree(int probType, bool isIntProb, int initialStrategy) :
+	BTree(probType, isIntProb),
+	numInFrontier(0),
+	nextCBFSLevel(0),
+	strategy(initialStrategy),
+	switchInterval(1000),
+	memoryLimit(0),
+	stallThreshold(0.0),
+	selectionsUntilCheck(1),
+	gapAtLastCheck(inf),
+	frontierAtLastCheck(0),
+	updatesAtSwitch(0)
+{
+	name = "*** Adaptive ***";
+    if ((strategy != DFS_ALG) && (strategy != BFS_ALG) && (strategy != CBFS_ALG))
+        throw ERROR << "AdaptiveTree only switches between DFS_ALG, BFS_ALG and CBFS_ALG; got " << strategy << ".";
+    adaptiveStats = new AdaptiveTreeStats();
+    tStats = adaptiveStats; // Make tStats pointer point to adaptiveStats
+}
+
+AdaptiveTree::~AdaptiveTree()
+{
+    // Calls BTree destructor by default
+	
+	// If states are not being retained in the dominance classes, we need 
+	// to make sure they're deleted from the tree prior to termination
+	if (!retainStates)
+	{
+		while (!isEmpty()) 
+		{
+		   State *ns = removeNextState();
+		   discardState(ns);
+		}
+	}
+
+    for (int i = 0; i < cbfsLevels.size(); ++i) {
+        delete cbfsLevels[i];
+    }
+}
+
+/*****************************************************************************/
+/* AdaptiveTree search functions                                             */
+/*****************************************************************************/
+State *AdaptiveTree::getNextState()
+{
+    // Counting selections here avoids summing the sharded explored counter
+    // on every selection
+    if (--selectionsUntilCheck <= 0) 
+    {
+        selectionsUntilCheck = switchInterval;
+        updateStrategy();
+    }
+
+    State *nextState = removeNextState();
+    while ((nextState->isDominated()) && (!isEmpty())) {
+        skipState(nextState);
+        nextState = removeNextState();
+        ++tStats->statesPrunedByDomBeforeExploration;
+    }
+
+    if (strategy == DFS_ALG) ++adaptiveStats->statesExploredWithDFS;
+    else if (strategy == BFS_ALG) ++adaptiveStats->statesExploredWithBFS;
+    else ++adaptiveStats->statesExploredWithCBFS;
+
+    return nextState;
+}
+
+State *AdaptiveTree::removeNextState()
+{
+    State *nextState;
+    if (strategy == DFS_ALG)
+    {
+        nextState = dfsStates.back();
+        dfsStates.pop_back();
+    }
+    else if (strategy == BFS_ALG)
+    {
+        nextState = bfsStates.top();
+        bfsStates.pop();
+    }
+    else // strategy == CBFS_ALG
+    {
+        // Cycle through the levels, taking the best state from the next 
+        // nonempty one
+        int numLevels = cbfsLevels.size();
+        int level = nextCBFSLevel % numLevels;
+        while (cbfsLevels[level]->empty())
+            level = (level + 1) % numLevels;
+        nextState = cbfsLevels[level]->top();
+        cbfsLevels[level]->pop();
+        nextCBFSLevel = level + 1;
+    }
+    --numInFrontier;
+    return nextState;
+}
+
+void AdaptiveTree::saveStateForExploration(State *s)
+{
+    insertState(s);
+    ++numInFrontier;
+    return;
+}
+
+void AdaptiveTree::saveStatesForExploration(vector<State*>& states)
+{
+    if (strategy == BFS_ALG)
+        bfsStates.push(states.begin(), states.end());
+    else
+    {
+        for (int i = 0; i < states.size(); ++i)
+            insertState(states[i]);
+    }
+    numInFrontier += states.size();
+    return;
+}
+
+void AdaptiveTree::insertState(State *s)
+{
+    if (strategy == DFS_ALG) 
+        dfsStates.push_back(s);
+    else if (strategy == BFS_ALG)
+        bfsStates.push(s);
+    else // strategy == CBFS_ALG
+    {
+        int level = s->getDepth();
+        while (cbfsLevels.size() <= level) 
+            cbfsLevels.push_back(new state_priority_queue());
+        cbfsLevels[level]->push(s);
+    }
+    return;
+}
+
+State *AdaptiveTree::peekBestBoundState()
+{
+    if (strategy == BFS_ALG)
+        return bfsStates.empty() ? NULL : bfsStates.top();
+
+    if (strategy == CBFS_ALG)
+    {
+        State *best = NULL;
+        for (int i = 0; i < cbfsLevels.size(); ++i) 
+        {
+            if (cbfsLevels[i]->empty()) continue;
+            State *s = cbfsLevels[i]->top();
+            if ((best == NULL) ||
+                ((problemType == MIN) && (s->getLB() < best->getLB())) ||
+                ((problemType == MAX) && (s->getUB() > best->getUB())))
+                best = s;
+        }
+        return best;
+    }
+    return NULL; // Would require a scan of the whole DFS stack
+}
+
+/*****************************************************************************/
+/* AdaptiveTree strategy controller                                          */
+/*****************************************************************************/
+void AdaptiveTree::updateStrategy()
+{
+    double gap = currentGap();
+    bool haveIncumbent = (gap < inf);
+
+    if (strategy == DFS_ALG) 
+    {
+        // DFS has done its job once there is an incumbent to prune with
+        if (haveIncumbent) switchStrategy(BFS_ALG);
+    }
+    else if (strategy == BFS_ALG)
+    {
+        bool overMemory = (memoryLimit > 0) && (numInFrontier > memoryLimit);
+        bool stalled = haveIncumbent && (gapAtLastCheck - gap < stallThreshold) &&
+                       (numInFrontier > frontierAtLastCheck);
+        if (overMemory || stalled) switchStrategy(CBFS_ALG);
+    }
+    else // strategy == CBFS_ALG
+    {
+        // Go back to BFS once CBFS has found a better incumbent and the 
+        // frontier is small enough again
+        bool underMemory = (memoryLimit == 0) || (numInFrontier < memoryLimit / 2);
+        if (underMemory && (tStats->timesBestStateWasUpdated > updatesAtSwitch))
+            switchStrategy(BFS_ALG);
+    }
+
+    gapAtLastCheck = gap;
+    frontierAtLastCheck = numInFrontier;
+    return;
+}
+
+void AdaptiveTree::switchStrategy(int newStrategy)
+{
+    if (newStrategy == strategy) return;
+
+    if (debug > 0) 
+    {
+        const char* names[] = { "", "CBFS", "DFS", "", "BFS" };
+        printf("Switching node selection from %s to %s (%d states in tree)\n",
+               names[strategy], names[newStrategy], numInFrontier);
+    }
+
+    // Take every state out of the current structure...
+    vector<State *> states;
+    if (strategy == DFS_ALG) 
+        states.swap(dfsStates);
+    else if (strategy == BFS_ALG) 
+        bfsStates.take_all(states);
+    else // strategy == CBFS_ALG
+    {
+        for (int i = 0; i < cbfsLevels.size(); ++i) 
+            cbfsLevels[i]->take_all(states);
+    }
+
+    // ...and move them into the new one
+    strategy = newStrategy;
+    nextCBFSLevel = 0;
+    if (strategy == DFS_ALG)
+    {
+        // Best states go on top of the stack
+        std::sort(states.begin(), states.end(), StateComparator());
+        dfsStates.swap(states);
+    }
+    else if (strategy == BFS_ALG) 
+        bfsStates.push(states.begin(), states.end());
+    else // strategy == CBFS_ALG
+    {
+        for (int i = 0; i < states.size(); ++i)
+            insertState(states[i]);
+    }
+
+    ++adaptiveStats->strategySwitches;
+    updatesAtSwitch = tStats->timesBestStateWasUpdated;
+    return;
+}
+
+double AdaptiveTree::currentGap()
+{
+    // Relative gap between the incumbent and the best bound we can see
+    double incumbent = (problemType == MIN) ? globalUpperBound : globalLowerBound;
+    if ((bestState == NULL) && ((incumbent == std::numeric_limits<double>::min()) ||
+        (fabs(incumbent) >= std::numeric_limits<double>::max())))
+        return inf; // No incumbent yet; the global bound has its initial value
+
+    State *best = peekBestBoundState();
+    double bound;
+    if (problemType == MIN) 
+        bound = best ? best->getLB() : globalLowerBound;
+    else // problemType == MAX
+        bound = best ? best->getUB() : globalUpperBound;
+    if (fabs(bound) >= std::numeric_limits<double>::max()) return inf;
+
+    return fabs(incumbent - bound) / std::max(fabs(incumbent), 1.0);
+}
+
+/*****************************************************************************/
+/* AdaptiveTreeStats function definitions                                    */
+/*****************************************************************************/
+AdaptiveTreeStats::AdaptiveTreeStats()
+{
+    // Calls TreeStats constructor by default
+    strategySwitches = 0;
+    statesExploredWithDFS = 0;
+    statesExploredWithBFS = 0;
+    statesExploredWithCBFS = 0;
+}
+
+AdaptiveTreeStats::~AdaptiveTreeStats()
+{
+    // Calls TreeStats destructor by default
+    // Clean-up
+}
+
+void AdaptiveTreeStats::print() const
+{
+    TreeStats::print();
+    printf("Printing Adaptive Tree Stats\n");
+    printf("%d switches of the node selection strategy\n", strategySwitches);
+    printf("%lld states selected with DFS, %lld with BFS, %lld with CBFS\n",
+           statesExploredWithDFS, statesExploredWithBFS, statesExploredWithCBFS);
+    return;
+}
+
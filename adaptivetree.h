@@ -0,0 +1,108 @@
+/*****************************************************************************/
+/* File: adaptivetree.h                                                      */
+/* Description:                                                              */
+/*   Contains the design details for a branching tree class that switches    */
+/*   between DFS, BFS and CBFS node selection while the search is running.   */
+/*****************************************************************************/
+#ifndef ADAPTIVETREE_H
+#define ADAPTIVETREE_H
+
+// Required include's
+#include <vector>
+using std::vector;
+
+// Forward Declarations
+class State;
+class BTree;
+struct TreeStats;
+
+// Used for tracking search statistics
+struct AdaptiveTreeStats : public TreeStats
+{
+    AdaptiveTreeStats();
+    virtual ~AdaptiveTreeStats();
+    virtual void print() const;
+
+    // Variables for AdaptiveTreeStats
+    int strategySwitches;
+    long long statesExploredWithDFS;
+    long long statesExploredWithBFS;
+    long long statesExploredWithCBFS;
+};
+
+// The adaptive tree starts with DFS until an incumbent is found, then moves to
+// BFS to close the gap.  If the frontier grows past the memory limit, or the 
+// gap stops closing while the frontier keeps growing, it falls back to CBFS, 
+// and returns to BFS once CBFS has improved the incumbent and the frontier 
+// has shrunk again.  Switching migrates the stored states between the 
+// frontier structures; no state is solved twice.
+//
+// The CBFS mode is a simplified round-robin that takes the best state of 
+// each nonempty depth level in turn; none of CBFSTree's selection methods or 
+// level thresholds apply.  The initial strategy must be DFS_ALG, BFS_ALG or 
+// CBFS_ALG.
+class AdaptiveTree : public BTree
+{
+  public:
+    // Class functions unique to AdaptiveTree
+    AdaptiveTree(int probType, bool isIntProb, int initialStrategy = DFS_ALG);
+    virtual ~AdaptiveTree();
+
+    // Number of selected states between two evaluations of the controller
+    void setSwitchInterval(int interval) { switchInterval = interval; }
+    // Frontier size above which BFS falls back to CBFS (0 means no limit)
+    void setMemoryLimit(int maxStates) { memoryLimit = maxStates; }
+    // Minimum relative gap closure per interval for BFS to be making progress
+    void setStallThreshold(double threshold) { stallThreshold = threshold; }
+
+    int getStrategy() const { return strategy; }
+
+  protected:
+    // Variables
+    vector<State *> dfsStates;
+    state_priority_queue bfsStates;
+    vector<state_priority_queue *> cbfsLevels;
+    int numInFrontier;
+    int nextCBFSLevel;
+
+    // For tracking adaptive search statistics 
+    AdaptiveTreeStats *adaptiveStats;
+
+    // Abstract class functions inherited from BTree that will be implemented
+    virtual bool isEmpty() const;
+    virtual State *getNextState();
+    virtual void saveStateForExploration(State *s);
+    virtual void saveStatesForExploration(vector<State*>& states);
+    virtual State *peekBestBoundState();
+
+    // Class functions specific to AdaptiveTree
+    State *removeNextState();
+    void insertState(State *s);
+    void updateStrategy();
+    void switchStrategy(int newStrategy);
+    double currentGap();
+
+    // Controller parameters and state
+    int strategy;
+    int switchInterval;
+    int memoryLimit;
+    double stallThreshold;
+    int selectionsUntilCheck;
+    double gapAtLastCheck;
+    int frontierAtLastCheck;
+    int updatesAtSwitch;
+
+  private:
+    // Nothing
+};
+
+/*****************************************************************************/
+/* AdaptiveTree inline function definitions                                  */
+/*****************************************************************************/
+inline bool AdaptiveTree::isEmpty() const
+{
+    return (numInFrontier == 0);
+}
+
+#endif // ADAPTIVETREE_H
+
@@ -0,0 +1,159 @@
+/*****************************************************************************/
+/* File: beamtree.cpp                                                        */
+/* Description:                                                              */
+/*   Contains the implementation details for a beam search branching tree    */
+/*   class.                                                                  */
+/*****************************************************************************/
+#include "state.h"
+#include "btree.h"
+#include "iterativetree.h"
+#include "beamtree.h"
+#include "util.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/*****************************************************************************/
+/* BeamTree constructor, destructor, and initialization functions            */
+/*****************************************************************************/
+BeamTree::BeamTree(int probType, bool isIntProb, int width, bool isAnytime,
+                   int factor) :
+	IterativeTree(probType, isIntProb),
+	numInBeam(0),
+	curLevel(0),
+	initialWidth(width),
+	beamWidth(width),
+	anytime(isAnytime),
+	widthFactor(factor)
+{
+	name = anytime ? "*** Anytime Beam ***" : "*** Beam ***";
+    if (width < 1)
+        throw ERROR << "The beam width must be at least 1; got " << width << ".";
+    if (factor < 2)
+        throw ERROR << "The beam must at least double between iterations; got a factor of " << factor << ".";
+    beamStats = new BeamTreeStats();
+    tStats = beamStats; // Make tStats pointer point to beamStats
+    iterStats = beamStats;
+}
+
+BeamTree::~BeamTree()
+{
+    // Calls BTree destructor by default
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        while (!levels[i]->empty())
+        {
+            discardState(levels[i]->top());
+            levels[i]->pop();
+        }
+        delete levels[i];
+    }
+}
+
+/*****************************************************************************/
+/* BeamTree search functions                                                 */
+/*****************************************************************************/
+State *BeamTree::getNextState()
+{
+    if (numInBeam == 0) startNextIteration();
+
+    // Finish a level before moving on to the next one
+    while (levels[curLevel]->empty()) ++curLevel;
+    State *nextState = levels[curLevel]->top();
+    levels[curLevel]->pop();
+    --numInBeam;
+    return nextState;
+}
+
+void BeamTree::saveStateForExploration(State *s)
+{
+    if (startsNewSearch(s))
+    {
+        curLevel = 0;
+        beamWidth = initialWidth;
+        beamStats->finalWidth = beamWidth;
+    }
+
+    int level = s->getDepth();
+    while (levels.size() <= level) levels.push_back(new LevelQueue());
+    if (level < curLevel) curLevel = level;
+    levels[level]->push(s);
+    ++numInBeam;
+
+    // Keep only the best <beamWidth> states of the level
+    if (levels[level]->size() > beamWidth)
+    {
+        cutOff(levels[level]->removeAt(levels[level]->size() - 1));
+        --numInBeam;
+    }
+    return;
+}
+
+State *BeamTree::peekBestBoundState()
+{
+    // The best state overall is the best of the top states at each level
+    State *best = NULL;
+    for (size_t i = curLevel; i < levels.size(); ++i)
+    {
+        if (levels[i]->empty()) continue;
+        State *s = levels[i]->top();
+        if ((best == NULL) ||
+            ((problemType == MIN) && (s->getLB() < best->getLB())) ||
+            ((problemType == MAX) && (s->getUB() > best->getUB())))
+            best = s;
+    }
+    return best;
+}
+
+void BeamTree::startNextIteration()
+{
+    if (beamWidth > std::numeric_limits<int>::max() / widthFactor)
+        beamWidth = std::numeric_limits<int>::max();
+    else beamWidth *= widthFactor;
+    curLevel = 0;
+    levels[0]->push(restartFromRoot());
+    ++numInBeam;
+    beamStats->finalWidth = beamWidth;
+    if (debug >= 2)
+        printf("Starting iteration %lld with a beam width of %d\n",
+               beamStats->iterations, beamWidth);
+    return;
+}
+
+// Another iteration is only needed in anytime mode
+bool BeamTree::nextIterationNeeded() const
+{
+    return anytime && cutStatesCouldImprove();
+}
+
+// Without restarts, a dropped state that could have beaten the incumbent
+// means optimality was not proven
+bool BeamTree::droppedStates() const
+{
+    return !anytime && cutStatesCouldImprove();
+}
+
+/*****************************************************************************/
+/* BeamTreeStats function definitions                                        */
+/*****************************************************************************/
+BeamTreeStats::BeamTreeStats() :
+    finalWidth(0)
+{
+    // Calls IterativeTreeStats constructor by default
+}
+
+BeamTreeStats::~BeamTreeStats()
+{
+    // Calls IterativeTreeStats destructor by default
+    // Clean-up
+}
+
+void BeamTreeStats::print() const
+{
+    TreeStats::print();
+    // Put extra BeamTree printing here
+    printf("Printing Beam Tree Stats\n");
+    printf("Iterations: %lld (final beam width %d)\n", iterations, finalWidth);
+    printf("States dropped from the beam: %lld\n", statesCutOff);
+    return;
+}
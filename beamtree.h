@@ -0,0 +1,91 @@
+/*****************************************************************************/
+/* File: beamtree.h                                                          */
+/* Description:                                                              */
+/*   Contains the design details for a beam search branching tree class.     */
+/*****************************************************************************/
+#ifndef BEAMTREE_H
+#define BEAMTREE_H
+
+// Required include's
+#include <vector>
+using std::vector;
+#include <limits>
+
+#include "levelqueue.h"
+
+// Forward Declarations
+class State;
+class IterativeTree;
+struct IterativeTreeStats;
+
+// Used for tracking search statistics
+struct BeamTreeStats : public IterativeTreeStats
+{
+    BeamTreeStats();
+    virtual ~BeamTreeStats();
+    virtual void print() const;
+
+    // Variables for BeamTreeStats
+    int finalWidth;
+};
+
+// Breadth-first search that keeps only the best <width> states of each depth
+// level (as ordered by State::operator<); whenever a level overflows, its
+// worst state is deleted.  Memory is bounded by width times depth, and an
+// incumbent is found after about width times depth explored states.
+//
+// On its own the search is a heuristic: it ends once the beam is empty, and
+// if a dropped state could still have beaten the incumbent, the search is
+// reported as not having proven optimality.  In anytime mode the search
+// instead restarts from a copy of the root with the width multiplied by
+// <widthFactor> (at least 2), as long as a dropped state could still beat
+// the incumbent, so that it eventually proves optimality.  The global bound
+// accounts for the dropped states in both modes.  See IterativeTree for the
+// restrictions that come with the restarts.
+class BeamTree : public IterativeTree
+{
+  public:
+    // Class functions unique to BeamTree
+    BeamTree(int probType, bool isIntProb, int width, bool isAnytime = false,
+             int factor = 2);
+    virtual ~BeamTree();
+
+  protected:
+    // Variables
+    vector<LevelQueue *> levels;
+    size_t numInBeam;
+    int curLevel; // Shallowest level that may be nonempty
+    int initialWidth;
+    int beamWidth;
+    bool anytime;
+    int widthFactor;
+
+    // For tracking beam search statistics
+    BeamTreeStats *beamStats;
+
+    // Abstract class functions inherited from BTree that will be implemented
+    virtual bool isEmpty() const;
+    virtual State *getNextState();
+    virtual void saveStateForExploration(State *s);
+    virtual State *peekBestBoundState();
+    virtual bool droppedStates() const;
+
+    // Class functions inherited from IterativeTree
+    virtual bool nextIterationNeeded() const;
+
+    // Class functions specific to BeamTree
+    void startNextIteration();
+
+  private:
+    // Nothing
+};
+
+/*****************************************************************************/
+/* BeamTree inline function definitions                                      */
+/*****************************************************************************/
+inline bool BeamTree::isEmpty() const
+{
+    return (numInBeam == 0) && !nextIterationReady();
+}
+
+#endif // BEAMTREE_H
@@ -8,15 +8,19 @@
 #include "state.h"
 #include "btree.h"
 #include "bfstree.h"
+#include "util.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
 
 /*****************************************************************************/
 /* BFSTree constructor, destructor, and initialization functions             */
 /*****************************************************************************/
 BFSTree::BFSTree(int probType, bool isIntProb) :
-	BTree(probType, isIntProb)
+	BTree(probType, isIntProb),
+	useCompositeKey(false),
+	nextSeq(0)
 {
 	name = "*** BFS ***";
     bfsStats = new BFSTreeStats();
@@ -34,7 +38,7 @@ BFSTree::~BFSTree()
 		while (!isEmpty()) 
 		{
 		   State *ns = getNextState();
-		   delete ns;
+		   discardState(ns);
 		}
 	}
 }
@@ -44,22 +48,85 @@ BFSTree::~BFSTree()
 /*****************************************************************************/
 State *BFSTree::getNextState()
 {
-    State *nextState = unexploredStates.top();
-    unexploredStates.pop();
-    while ((nextState->isDominated()) && (!unexploredStates.empty())) {
-        nextState = unexploredStates.top();
-        unexploredStates.pop();
+    State *nextState = popBestState();
+    while ((nextState->isDominated()) && (!isEmpty())) {
+        skipState(nextState);
+        nextState = popBestState();
         ++tStats->statesPrunedByDomBeforeExploration;
     }
     return nextState;
 }
 
+State *BFSTree::popBestState()
+{
+    State *s;
+    if (useCompositeKey)
+    {
+        s = keyedStates.top().state;
+        keyedStates.pop();
+    }
+    else
+    {
+        s = unexploredStates.top();
+        unexploredStates.pop();
+    }
+    return s;
+}
+
 void BFSTree::saveStateForExploration(State *s)
 {
-    unexploredStates.push(s);
+    if (useCompositeKey) keyedStates.push(makeEntry(s));
+    else unexploredStates.push(s);
+    return;
+}
+
+void BFSTree::saveStatesForExploration(vector<State*>& states)
+{
+    if (useCompositeKey)
+    {
+        vector<BFSEntry> entries;
+        entries.reserve(states.size());
+        for (size_t i = 0; i < states.size(); ++i)
+            entries.push_back(makeEntry(states[i]));
+        keyedStates.push(entries.begin(), entries.end());
+    }
+    else unexploredStates.push(states.begin(), states.end());
+    return;
+}
+
+State *BFSTree::peekBestBoundState()
+{
+    // States are ordered by priority, which is normally their bound
+    if (isEmpty()) return NULL;
+    return useCompositeKey ? keyedStates.top().state : unexploredStates.top();
+}
+
+/*****************************************************************************/
+/* BFSTree miscellaneous function definitions                                */
+/*****************************************************************************/
+void BFSTree::setCompositeKey(bool b)
+{
+    if (!isEmpty())
+        throw ERROR << "The BFSTree key cannot be changed while states are stored.";
+    useCompositeKey = b;
     return;
 }
 
+// Bounds that round to the same integral value are equally good for an 
+// integral problem, so they are treated as ties
+BFSEntry BFSTree::makeEntry(State *s)
+{
+    BFSEntry e;
+    if (problemType == MIN)
+        e.bound = isOptIntegral ? -ceil(s->getLB() - eps) : -s->getLB();
+    else /* problemType == MAX */
+        e.bound = isOptIntegral ? floor(s->getUB() + eps) : s->getUB();
+    e.depth = s->getDepth();
+    e.seq = nextSeq++;
+    e.state = s;
+    return e;
+}
+
 /*****************************************************************************/
 /* BFSTreeStats function definitions                                        */
 /*****************************************************************************/
@@ -13,6 +13,27 @@ class State;
 class BTree;
 struct TreeStats;
 
+// Entry of the composite-key frontier (see BFSTree::setCompositeKey); the 
+// key is computed when the state is stored
+struct BFSEntry
+{
+    double bound; // Oriented so that higher is better
+    int depth;
+    long long seq; // Insertion order
+    State *state;
+};
+
+// Orders entries for a max-heap: better bound, then deeper, then older
+struct BFSEntryOrder
+{
+    bool operator()(const BFSEntry& x, const BFSEntry& y) const
+    {
+        if (x.bound != y.bound) return x.bound < y.bound;
+        if (x.depth != y.depth) return x.depth < y.depth;
+        return x.seq > y.seq;
+    }
+};
+
 // Used for tracking search statistics
 struct BFSTreeStats : public TreeStats
 {
@@ -30,9 +51,19 @@ class BFSTree : public BTree
     BFSTree(int probType, bool isIntProb);
     virtual ~BFSTree();
 
+    // Orders the states by bound (rounded to the next integral value for 
+    // integral problems), breaking ties by depth, deepest first, and then 
+    // by insertion order, instead of by State::operator<.  Diving within a 
+    // plateau of equal bounds reaches solutions sooner and keeps the 
+    // frontier small.  Must be set before any state is stored.
+    void setCompositeKey(bool b);
+
   protected:
     // Variables
     state_priority_queue unexploredStates;
+    batch_priority_queue<BFSEntry, BFSEntryOrder> keyedStates;
+    bool useCompositeKey;
+    long long nextSeq;
 
     // For tracking BFS search statistics 
     BFSTreeStats *bfsStats;
@@ -41,6 +72,12 @@ class BFSTree : public BTree
     virtual bool isEmpty() const;
     virtual State *getNextState();
     virtual void saveStateForExploration(State *s);
+    virtual void saveStatesForExploration(vector<State*>& states);
+    virtual State *peekBestBoundState();
+
+    // Class functions specific to BFSTree
+    State *popBestState();
+    BFSEntry makeEntry(State *s);
 
   private:
     // Nothing
@@ -51,7 +88,7 @@ class BFSTree : public BTree
 /*****************************************************************************/
 inline bool BFSTree::isEmpty() const
 {
-    return unexploredStates.empty();
+    return useCompositeKey ? keyedStates.empty() : unexploredStates.empty();
 }
 
 #endif // BFSTREE_H
@@ -34,7 +34,7 @@ BrFSTree::~BrFSTree()
 		while (!isEmpty()) 
 		{
 		   State *ns = getNextState();
-		   delete ns;
+		   discardState(ns);
 		}
 	}
 }
@@ -47,6 +47,7 @@ State *BrFSTree::getNextState()
     State *nextState = unexploredStates.front();
     unexploredStates.pop();
     while ((nextState->isDominated()) && (!unexploredStates.empty())) {
+        skipState(nextState);
         nextState = unexploredStates.front();
         unexploredStates.pop();
         ++tStats->statesPrunedByDomBeforeExploration;
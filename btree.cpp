@@ -8,12 +8,37 @@
 #include "state.h"
 #include "btree.h"
 #include "util.h"
+#include "threadpool.h"
+#include "transtable.h"
+#include "statsserver.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
 #include <limits>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+// Adds the time spent in its scope to *total, if total is not NULL
+class PhaseTimer
+{
+  public:
+	PhaseTimer(double *t) : total(t) 
+	{ 
+		if (total) start = std::chrono::steady_clock::now(); 
+	}
+	~PhaseTimer() 
+	{ 
+		if (total) *total += std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count(); 
+	}
+
+  private:
+	double *total;
+	std::chrono::steady_clock::time_point start;
+};
 
 /*****************************************************************************/
 /* BTree destructor and initialization functions                             */
@@ -28,34 +53,66 @@ BTree::BTree(int probType, bool isIntProb) :
 	nextNodeID(0),
 	nextEdgeID(0),
 	exploredStates(0),
+	curState(NULL),
+	diving(false),
+	nextDiveAt(0),
+	lastDiveStartID(-1),
 	tulipOutputFile(NULL),
 	debug(1),
 	useDom(false),
 	retainStates(true),
+	releaseExplored(false),
+	deltaEncoding(false),
 	useFinalTests(false),
 	findAllSolns(false),
 	outputRate(1000),
+	estimateRate(1000),
+	phaseTiming(false),
+	trackBestBound(false),
 	stateComputesBounds(false),
+	lazyBounds(false),
+	diveFrequency(0),
+	diveMaxDepth(0),
 	nodeLimit(0),
 	timeLimit(0.0),
 	stopAtFirstImprov(false),
-	saveNonTerm(false)
+	relGapTol(0.0),
+	absGapTol(0.0),
+	saveNonTerm(false),
+	nextEstimateAt(0),
+	estimatedTreeSize(0.0),
+	estimatedTimeLeft(-1.0),
+	estimatedGapTime(-1.0),
+	firstGap(-1.0),
+	firstGapTime(-1.0),
+	boundPool(NULL),
+	numPendingBounds(0),
+	boundAborted(false),
+	deterministic(false),
+	boundRoundSize(64),
+	nextRoundAt(0),
+	rng(1),
+	transTable(NULL),
+	statsServer(NULL),
+	statsPublishRate(0),
+	nextPublishAt(0)
 {
 	/* Do nothing */
 }
 
 BTree::~BTree()
 {
+	// States still out with the bounding threads never made it into the tree
+	if (boundPool) boundPool->wait();
+	for (int i = 0; i < boundedStates.size(); ++i) delete boundedStates[i];
+	for (int i = 0; i < abortedStates.size(); ++i) delete abortedStates[i];
+	delete boundPool;
+	delete transTable;
+	delete statsServer;
     if (retainStates) {
         // Need to delete all nodes if they've been retained (either for 
         // dominance or other purposes, such as tracking branching decisions)
-        for (auto dcI = domClasses.begin(); dcI != domClasses.end();++dcI){
-            DomClass *domClass = dcI->second;
-            for (auto s = domClass->begin(); s != domClass->end(); ++s) {
-                delete *s;
-            }
-            delete domClass;
-        }
+        domClasses.deleteAllStates();
     } 
 	delete tStats;
 	delete bestState;
@@ -73,35 +130,119 @@ void BTree::explore()
 {
 	runTimeStart = clock() - tStats->totalTime;
 	bool finished = true;
-    while ((!isEmpty()) && (keepExploring)) 
+	boundAborted = false;
+
+	// The explored count is a sharded counter, so it is read once per 
+	// iteration, right after a state is explored
+	long long explored = tStats->statesExplored;
+    while ((!isEmpty() || numPendingBounds > 0) && (keepExploring)) 
 	{
+		// Requests from other threads; a pause is waited out here, so that 
+		// it does not count towards the search time
+		if (control.hasRequests() && !applyControlRequests()) 
+		{ 
+			keepExploring = false; 
+			finished = false; 
+			break; 
+		}
+
 		double loopStart = clock();
 		State* oldBest = bestState;
 
-        try { exploreNextState(); }
-		catch (AbortException& e) { keepExploring = false; finished = false;}
+		// Move states bounded by the worker threads into the tree, waiting 
+		// for one if there is nothing else to explore (in deterministic mode,
+		// only at the end of a round)
+		if ((numPendingBounds > 0) && 
+			(!deterministic || isEmpty() || (explored >= nextRoundAt)))
+			collectBoundedStates(isEmpty());
+		if (explored >= nextRoundAt) nextRoundAt = explored + boundRoundSize;
+		if (boundAborted && (!deterministic || (numPendingBounds == 0))) 
+		{ 
+			keepExploring = false; 
+			finished = false; 
+			break; 
+		}
+
+        try 
+		{ 
+			if (!isEmpty()) exploreNextState(); 
+			explored = tStats->statesExplored;
+			if (trackBestBound) updateGlobalBound();
+
+			// Periodically dive from the best-bound state to look for better 
+			// incumbents early in the search
+			if ((diveFrequency > 0) && (explored >= nextDiveAt) && !isEmpty())
+			{
+				nextDiveAt = explored + diveFrequency;
+				State* start = peekBestBoundState();
+				if (start && (start->getID() != lastDiveStartID) && 
+					!start->isDominated() && attemptHeuristicCompletion(start))
+				{
+					lastDiveStartID = start->getID();
+					dive(start);
+				}
+			}
+		}
+		catch (AbortException& e) 
+		{ 
+			keepExploring = false; 
+			finished = false; 
+			explored = tStats->statesExplored;
+		}
 
 		double loopEnd = clock();
 		tStats->totalTime += (loopEnd - loopStart);
 		if (oldBest != bestState) tStats->timeToOpt = tStats->totalTime;
+
+		if ((estimateRate > 0) && (explored >= nextEstimateAt))
+		{
+			nextEstimateAt = explored + estimateRate;
+			updateProgressEstimate();
+		}
+		if (statsServer && (explored >= nextPublishAt))
+		{
+			nextPublishAt = explored + statsPublishRate;
+			publishStats();
+		}
         
 		// Print output information
-        if ((debug > 0) && ((tStats->statesExplored % outputRate) == 0)) 
+        if ((debug > 0) && ((explored % outputRate) == 0)) 
+		{
+			if (estimateRate > 0) updateProgressEstimate();
             printProgress();
+		}
         
 		// Determine whether to keep exploring based on time / node limits
         keepExploring &= 
-            ((nodeLimit == 0 || tStats->statesExplored < nodeLimit) &&
+            ((nodeLimit == 0 || explored < nodeLimit) &&
              (timeLimit < eps || clock() - runTimeStart < timeLimit) && 
              (!stopAtFirstImprov || tStats->timesBestStateWasUpdated == 0) &&
-			 (globalLowerBound < globalUpperBound));
+			 (globalUpperBound - globalLowerBound > pruneTolerance()));
     }
 
+	// Put any states still being bounded into the tree so that they are 
+	// cleaned up (or explored by a later call to explore())
+	while (numPendingBounds > 0) collectBoundedStates(true);
+
+	// Make sure clients see the final state of the search
+	if (statsServer)
+	{
+		if (estimateRate > 0) updateProgressEstimate();
+		while (!publishStats()) std::this_thread::yield();
+	}
+
     if (debug > 0) {
         printf("* Finished *\n");
-        if ((globalLowerBound < globalUpperBound) && (!isEmpty() || !finished)) {
+        // A gap within the tolerance is proven whether or not states are left
+        bool withinTolerance = (globalUpperBound - globalLowerBound <= pruneTolerance());
+        if ((globalLowerBound < globalUpperBound) && !withinTolerance && 
+            (!isEmpty() || !finished || droppedStates())) {
             printf("Failed to explore entire tree; cannot guarantee "
                    "optimality\n");
+        } else if ((globalLowerBound < globalUpperBound) && withinTolerance && 
+                   (pruneTolerance() > eps)) {
+            printf("Search used an optimality gap tolerance of %g; final gap "
+                   "is %g\n", pruneTolerance(), globalUpperBound - globalLowerBound);
         }
         if (debug >= 2) {
             printOptSolution();
@@ -117,9 +258,11 @@ void BTree::explore()
 void BTree::exploreNextState()
 {
     State* ns = getNextState();
+	removeLiveState(ns);
 
-	if (ns->timeToExplore > tStats->statesExplored)
+	if ((ns->timeToExplore > 0) && (ns->timeToExplore > tStats->statesExplored))
 	{
+		addLiveState(ns);
 		saveStateForExploration(ns);
 		return;
 	}
@@ -127,14 +270,33 @@ void BTree::exploreNextState()
 	if (tulipOutputFile)
 	{
 		fprintf(tulipOutputFile, "(property 0 string \"viewLabel\" ");
-		fprintf(tulipOutputFile, "(node %d \"%d\"))\n", ns->getID(), exploredStates++);
+		fprintf(tulipOutputFile, "(node %lld \"%lld\"))\n", ns->getID(), exploredStates++);
 	}
 
     if (stateIsPrunable(ns)) 
 	{
-        if (!retainStates) delete ns;
+        releaseState(ns);
         return;
     }
+
+	// A delta-encoded state is rebuilt from its parent before it is used
+	if (ns->deltaParent) materializeState(ns);
+
+	// In lazy bounding mode, the state's real bounds are only computed now. 
+	// If they changed the state's priority, put it back so that the next 
+	// state is selected with accurate information.
+	if (ns->boundsDeferred && computeDeferredBounds(ns))
+	{
+		if (stateIsPrunable(ns)) 
+		{
+			releaseState(ns);
+			return;
+		}
+		++tStats->statesReinsertedAfterBounding;
+		addLiveState(ns);
+		saveStateForExploration(ns);
+		return;
+	}
     // Else if we get to this point, we weren't able to prune state using 
     // standard dominance or bounds. In some cases, we can now compute a more 
     // expensive dominance or bounds test that we ordinarily don't want to do. 
@@ -143,7 +305,7 @@ void BTree::exploreNextState()
         ns->applyFinalPruningTests(this);
         if (stateIsPrunable(ns)) 
 		{
-            if (!retainStates) delete ns;
+            releaseState(ns);
             return;        
         }
     }
@@ -156,11 +318,19 @@ void BTree::exploreNextState()
 
     tStats->numExploredAtLevel[ns->depth]++;
     ++tStats->statesExplored;
-    ns->branch(this);
+    curState = ns;
+    double nestedTime = tStats->boundingTime + tStats->dominanceTime;
+    {
+        PhaseTimer timer(phaseTiming ? &tStats->branchingTime : NULL);
+        ns->branch(this);
+    }
+    if (phaseTiming) 
+        tStats->branchingTime -= tStats->boundingTime + tStats->dominanceTime - nestedTime;
+    curState = NULL;
 
     // If dominance is not used, the state can be deleted after branching 
     // (assuming state does not need to be retained for branching decisions)
-    if (!retainStates) delete ns;
+    releaseState(ns);
 
      return;
 }
@@ -170,19 +340,8 @@ void BTree::exploreNextState()
 /*****************************************************************************/
 bool BTree::processState(State* s, bool isRoot)
 {
-	s->id = nextNodeID++;
-	if (tulipOutputFile)
-	{
-		fprintf(tulipOutputFile, "(nodes %d)\n", s->id);
-		if (s->parID != -1) 
-			fprintf(tulipOutputFile, "(edge %d %d %d)\n", nextEdgeID++, s->id, s->parID);
-		s->writeTulipOutput(tulipOutputFile);
-	}
-
-    while (s->depth >= tStats->numIdentifiedAtLevel.size()) 
-        tStats->numIdentifiedAtLevel.push_back(0);
-    ++tStats->numIdentifiedAtLevel[s->depth];
-    ++tStats->statesIdentified;
+	if (diving) return processDiveState(s);
+	identifyState(s);
 
     // If s is a terminal state, process it and return
     if (s->isTerminalState()) 
@@ -194,6 +353,14 @@ bool BTree::processState(State* s, bool isRoot)
 
 	if (saveNonTerm) saveBestState(s, true);
 
+    // Else check whether s has been seen before
+    if (transTable && stateIsDuplicate(s)) 
+	{
+        ++tStats->statesPrunedAsDuplicates;
+        delete s;
+        return false;
+    }
+
     // Else check s for dominance
     if (useDom) 
 	{
@@ -207,8 +374,18 @@ bool BTree::processState(State* s, bool isRoot)
     }
 
     // Else s is not dominated, so compute bounds and check pruning
-	if (!stateComputesBounds)
+	if (lazyBounds && !stateComputesBounds && !isRoot)
+		deferBounds(s);
+	else if (boundPool && !stateComputesBounds && !isRoot)
+	{
+		submitForBounding(s);
+		return true;
+	}
+	else if (!stateComputesBounds)
+	{
+		PhaseTimer timer(phaseTiming ? &tStats->boundingTime : NULL);
 		s->computeBounds(this);
+	}
 
     if (stateExceedsBounds(s)) 
 	{
@@ -233,27 +410,397 @@ bool BTree::processState(State* s, bool isRoot)
 		}
     }
 
-    // Else s is not prunable yet, so compute priority and store in the tree.
-    // Store non-terminal, non-prunable state in the appropriate dominance 
-    // class, creating a new class if none currently exists for it.
-    if (retainStates) 
+    // Else s is not prunable yet, so store it in the tree.
+    recordStoredState(s);
+    if (deltaEncoding) compactState(s);
+    addLiveState(s);
+    saveStateForExploration(s);
+
+    return true;
+}
+
+int BTree::processStates(vector<State*>& states)
+{
+    if (diving)
+    {
+        int numKept = 0;
+        for (int i = 0; i < states.size(); ++i)
+            if (processDiveState(states[i])) ++numKept;
+        states.clear();
+        return numKept;
+    }
+
+    // First pass: identify every state, processing terminal states right away
+    // and dropping duplicates
+    vector<State*> batch;
+    batch.reserve(states.size());
+    for (int i = 0; i < states.size(); ++i)
+    {
+        State* s = states[i];
+        identifyState(s);
+        if (s->isTerminalState()) 
+        {
+            processTerminalState(s);
+            continue;
+        }
+        if (saveNonTerm) saveBestState(s, true);
+        if (transTable && stateIsDuplicate(s))
+        {
+            ++tStats->statesPrunedAsDuplicates;
+            delete s;
+            continue;
+        }
+        batch.push_back(s);
+    }
+    states.clear();
+
+    // Second pass: check dominance against the states in memory and against
+    // the siblings in this batch that have survived so far
+    if (useDom)
+    {
+        int numKept = 0;
+        for (int i = 0; i < batch.size(); ++i)
+        {
+            State* s = batch[i];
+            applyDominanceRules(s);
+            for (int j = 0; (j < numKept) && !s->isDominated(); ++j)
+            {
+                if (batch[j]->getDomClassID() == s->getDomClassID()) 
+                    s->assessDominance(batch[j]);
+            }
+            if (stateIsDominated(s)) 
+            {
+                ++tStats->statesPrunedByDomBeforeInsertion;
+                delete s;
+            }
+            else batch[numKept++] = s;
+        }
+        batch.resize(numKept);
+    }
+
+    // Third pass: compute bounds for all remaining states together (or hand 
+    // them to the worker threads if bounding asynchronously, or defer them
+    // entirely if bounding lazily)
+    if (lazyBounds && !stateComputesBounds)
+    {
+        for (int i = 0; i < batch.size(); ++i)
+            deferBounds(batch[i]);
+    }
+    else if (boundPool && !stateComputesBounds)
+    {
+        for (int i = 0; i < batch.size(); ++i)
+            submitForBounding(batch[i]);
+        return batch.size();
+    }
+    else if (!stateComputesBounds)
+    {
+        PhaseTimer timer(phaseTiming ? &tStats->boundingTime : NULL);
+        for (int i = 0; i < batch.size(); ++i)
+            batch[i]->computeBounds(this);
+    }
+
+    // Last pass: drop states that are dominated (possibly by a later sibling) 
+    // or exceed the bounds, then insert the survivors in one operation
+    int numKept = 0;
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        State* s = batch[i];
+        if (stateIsDominated(s))
+        {
+            ++tStats->statesPrunedByDomBeforeInsertion;
+            delete s;
+        }
+        else if (stateExceedsBounds(s)) 
+        {
+            ++tStats->statesPrunedByBoundsBeforeInsertion;
+            delete s;
+        }
+        else 
+        {
+            recordStoredState(s);
+            if (deltaEncoding) compactState(s);
+            addLiveState(s);
+            batch[numKept++] = s;
+        }
+    }
+    batch.resize(numKept);
+    if (!batch.empty()) saveStatesForExploration(batch);
+
+    return numKept;
+}
+
+void BTree::saveStatesForExploration(vector<State*>& states)
+{
+    for (int i = 0; i < states.size(); ++i)
+        saveStateForExploration(states[i]);
+    return;
+}
+
+void BTree::setBoundThreads(int numThreads)
+{
+	while (numPendingBounds > 0) collectBoundedStates(true);
+	delete boundPool;
+	boundPool = (numThreads > 0) ? new ThreadPool(numThreads) : NULL;
+}
+
+void BTree::submitForBounding(State *s)
+{
+	++numPendingBounds;
+	boundPool->submit([this, s]() 
 	{
-        auto domClassPos = domClasses.find(s->getDomClassID());
-        if (domClassPos == domClasses.end()) 
+		bool aborted = false;
+		try { s->computeBounds(this); }
+		catch (AbortException& e) { aborted = true; }
+
+		std::unique_lock<std::mutex> lock(boundMutex);
+		if (aborted) 
 		{
-            DomClass* domClass = new DomClass();
-            domClass->push_back(s);
-            domClasses[s->getDomClassID()] = domClass;
-        } else domClassPos->second->push_back(s);
-    }
+			boundAborted = true;
+			abortedStates.push_back(s);
+		}
+		else boundedStates.push_back(s);
+		boundCond.notify_one();
+	});
+	return;
+}
 
-    while (s->depth >= tStats->numStoredAtLevel.size()) 
-        tStats->numStoredAtLevel.push_back(0);
-    ++tStats->numStoredAtLevel[s->depth];
-    ++tStats->statesStoredInTree;
-    saveStateForExploration(s);
+void BTree::collectBoundedStates(bool wait)
+{
+	vector<State*> ready;
+	vector<State*> aborted;
+	{
+		std::unique_lock<std::mutex> lock(boundMutex);
+		if (deterministic)
+		{
+			// A round only ends once all of its states are back
+			while (boundedStates.size() + abortedStates.size() < numPendingBounds)
+				boundCond.wait(lock);
+		}
+		else while (wait && boundedStates.empty() && abortedStates.empty())
+			boundCond.wait(lock);
+		ready.swap(boundedStates);
+		aborted.swap(abortedStates);
+	}
+	numPendingBounds -= ready.size() + aborted.size();
 
-    return true;
+	// States whose bounding was aborted have no valid bounds, so they are 
+	// dropped like a state whose exploration was aborted
+	for (int i = 0; i < aborted.size(); ++i) delete aborted[i];
+
+	// Insert the states in the order they were identified, which does not 
+	// depend on how the threads were scheduled
+	if (deterministic)
+		std::sort(ready.begin(), ready.end(), 
+				  [](State* a, State* b) { return a->getID() < b->getID(); });
+
+	// Bounds are now known, so finish processing these states the same way 
+	// processState() would have
+	for (int i = 0; i < ready.size(); ++i)
+	{
+		State* s = ready[i];
+		if (stateExceedsBounds(s)) 
+		{
+			++tStats->statesPrunedByBoundsBeforeInsertion;
+			delete s;
+			continue;
+		} 
+		recordStoredState(s);
+		addLiveState(s);
+		saveStateForExploration(s);
+	}
+	return;
+}
+
+void BTree::setTranspositionTable(size_t maxEntries)
+{
+	delete transTable;
+	transTable = (maxEntries > 0) ? new TranspositionTable(maxEntries) : NULL;
+}
+
+// Waits while the search is paused, then applies the requests made through 
+// the control handle.  Returns false if the search should stop.
+bool BTree::applyControlRequests()
+{
+	std::unique_lock<std::mutex> lock(control.controlMutex);
+	while (control.paused && !control.stopRequested)
+		control.resumed.wait(lock);
+	control.pending = false;
+
+	if (control.nodeLimit > 0)
+	{
+		if ((nodeLimit == 0) || (control.nodeLimit < nodeLimit)) 
+			nodeLimit = control.nodeLimit;
+		control.nodeLimit = 0;
+	}
+	if (control.timeLimit > 0)
+	{
+		double lim = control.timeLimit * CLOCKS_PER_SEC;
+		if ((timeLimit < eps) || (lim < timeLimit)) timeLimit = lim;
+		control.timeLimit = 0;
+	}
+
+	// Offered bounds act like setGlobalLB/setGlobalUB, but only tighten
+	if (control.lowerBound > globalLowerBound) globalLowerBound = control.lowerBound;
+	if (control.upperBound < globalUpperBound) globalUpperBound = control.upperBound;
+	control.lowerBound = -std::numeric_limits<double>::max();
+	control.upperBound = std::numeric_limits<double>::max();
+
+	bool stop = control.stopRequested;
+	control.stopRequested = false;
+
+	// Merge solutions from other threads once the lock is released
+	vector<State*> solutions;
+	solutions.swap(control.solutions);
+	lock.unlock();
+	for (int i = 0; i < solutions.size(); ++i)
+	{
+		++tStats->externalStatesSubmitted;
+		if (solutions[i]->isTerminalState())
+			processHeuristicState(solutions[i]);
+		else
+		{
+			++tStats->externalStatesRejected;
+			delete solutions[i];
+		}
+	}
+	return !stop;
+}
+
+void BTree::setBestBoundTracking(bool b)
+{
+	// States already in the tree would be missing from the index (or stay 
+	// in it), which would give a wrong global bound
+	if ((b != trackBestBound) && (tStats->liveStates > 0))
+		throw ERROR << "Best-bound tracking must be set before states are stored in the tree.";
+	trackBestBound = b;
+}
+
+void BTree::setStatsServer(const char* socketPath, int publishRate)
+{
+	delete statsServer;
+	statsServer = NULL;
+	if (socketPath == NULL) return;
+	if (publishRate <= 0)
+		throw ERROR << "The stats publish rate must be positive; got " << publishRate << ".";
+
+	statsServer = new StatsServer(socketPath);
+	statsPublishRate = publishRate;
+	nextPublishAt = 0;
+	phaseTiming = true;
+}
+
+void BTree::deferBounds(State *s)
+{
+	// The parent's bound is valid for all of its children
+	if (curState)
+	{
+		if (problemType == MIN) s->lowerBound = std::max(s->lowerBound, curState->lowerBound);
+		else /* problemType == MAX */ s->upperBound = std::min(s->upperBound, curState->upperBound);
+	}
+	s->boundsDeferred = true;
+	++tStats->boundComputationsDeferred;
+	return;
+}
+
+bool BTree::computeDeferredBounds(State *s)
+{
+	// Returns true if the newly computed bound differs from the inherited one
+	double oldBound = (problemType == MIN) ? s->lowerBound : s->upperBound;
+	s->boundsDeferred = false;
+	{
+		PhaseTimer timer(phaseTiming ? &tStats->boundingTime : NULL);
+		s->computeBounds(this);
+	}
+	++tStats->deferredBoundsComputed;
+
+	double newBound = (problemType == MIN) ? s->lowerBound : s->upperBound;
+	return (fabs(newBound - oldBound) > eps);
+}
+
+void BTree::dive(State *start)
+{
+	// Dive below a copy of start; every state along the dive is kept until the
+	// dive finishes in case children refer to their parents
+	vector<State*> diveStates;
+	State* cur = start->clone();
+	if (start->deltaParent)
+	{
+		cur->materialize(start->deltaParent);
+		cur->deltaParent = NULL;
+	}
+	State* prevState = curState;
+	long long oldUpdates = tStats->timesBestStateWasUpdated;
+
+	++tStats->divesPerformed;
+	diving = true;
+	try
+	{
+		for (int d = 0; (cur != NULL) && (d < diveMaxDepth); ++d)
+		{
+			diveStates.push_back(cur);
+			diveChildren.clear();
+
+			curState = cur;
+			cur->branch(this);
+			++tStats->diveStatesExplored;
+
+			// Follow the child with the highest priority; discard the rest
+			cur = NULL;
+			for (int i = 0; i < diveChildren.size(); ++i)
+			{
+				if (cur == NULL || (*cur < *diveChildren[i])) cur = diveChildren[i];
+			}
+			for (int i = 0; i < diveChildren.size(); ++i)
+			{
+				if (diveChildren[i] != cur) delete diveChildren[i];
+			}
+			diveChildren.clear();
+		}
+	}
+	catch (AbortException& e)
+	{
+		for (int i = 0; i < diveChildren.size(); ++i) delete diveChildren[i];
+		diveChildren.clear();
+		cur = NULL;
+		diving = false;
+		curState = prevState;
+		for (int i = 0; i < diveStates.size(); ++i) delete diveStates[i];
+		throw;
+	}
+	diving = false;
+	curState = prevState;
+
+	delete cur; // Unexplored state left when the depth limit was reached
+	for (int i = 0; i < diveStates.size(); ++i) delete diveStates[i];
+
+	if (tStats->timesBestStateWasUpdated != oldUpdates) 
+		++tStats->diveImprovements;
+	return;
+}
+
+bool BTree::processDiveState(State *s)
+{
+	// States found while diving are never stored in the tree; terminal states
+	// are treated as heuristic solutions
+	if (s->isTerminalState())
+	{
+		processTerminalState(s, false);
+		return true;
+	}
+
+	if (!stateComputesBounds)
+		s->computeBounds(this);
+
+	double tol = pruneTolerance();
+	if (((problemType == MIN) && (s->getLB() >= globalUpperBound - tol)) ||
+		((problemType == MAX) && (s->getUB() <= globalLowerBound + tol)))
+	{
+		delete s;
+		return false;
+	}
+
+	diveChildren.push_back(s);
+	return true;
 }
 
 void BTree::processHeuristicState(State *s)
@@ -264,8 +811,9 @@ void BTree::processHeuristicState(State *s)
 
 bool BTree::attemptHeuristicCompletion(State *s) 
 {
-    return (((problemType == MIN) && (s->getLB() < globalUpperBound - eps)) ||
-            ((problemType == MAX) && (s->getUB() > globalLowerBound + eps)));
+    double tol = pruneTolerance();
+    return (((problemType == MIN) && (s->getLB() < globalUpperBound - tol)) ||
+            ((problemType == MAX) && (s->getUB() > globalLowerBound + tol)));
 }
 
 void BTree::resetBest()
@@ -307,7 +855,7 @@ void BTree::processTerminalState(State *s, bool isTreeNode)
 	if (tulipOutputFile)
 	{
 		fprintf(tulipOutputFile, "(property 0 color \"viewColor\" ");
-		fprintf(tulipOutputFile, "(node %d \"(0, 255, 0, 255)\"))\n", s->id);
+		fprintf(tulipOutputFile, "(node %lld \"(0, 255, 0, 255)\"))\n", s->id);
 	}
 
 	saveBestState(s, isTreeNode);
@@ -317,26 +865,282 @@ void BTree::processTerminalState(State *s, bool isTreeNode)
 
 void BTree::applyDominanceRules(State *s)
 {
+    PhaseTimer timer(phaseTiming ? &tStats->dominanceTime : NULL);
+
     // Check memory for dominance, marking states that this state dominates 
-    // and checking if this state is dominated by any state
-    auto domClassPos = domClasses.find(s->getDomClassID());
-    if ((domClassPos == domClasses.end()) || (domClassPos->second == NULL)) { 
-        // No dominance class exists yet
-        return;
-    } // else assess dominance for each state in dominance class
-    DomClass *domC = domClassPos->second;
-    // Determine if state is dominated by or dominates any state
-    for (auto dcI = domC->begin(); dcI != domC->end(); ++dcI) {
-        s->assessDominance(*dcI);
-        if (s->isDominated()) break;
+    // and checking if this state is dominated by any state (nothing to do if 
+    // no dominance class exists yet)
+    domClasses.withClass(s->getDomClassID(), [this, s](DomClass& domC) 
+    {
+        // Determine if state is dominated by or dominates any state
+        for (size_t i = 0; i < domC.size(); ++i) {
+            if (domC[i]) s->assessDominance(domC[i]);
+            else s->assessSignatureDominance(domC.signature(i));
+            if (s->isDominated()) {
+                domC.touch(i, domClasses.tick());
+                return;
+            }
+        }
+
+        // States dropped from this class might have dominated s
+        if (domC.evictions() > 0) ++tStats->statesCheckedAfterEviction;
+    });
+    return;
+}
+
+void BTree::identifyState(State *s)
+{
+	s->id = nextNodeID++;
+
+	// States are usually copied from their parent, which carries the tree's
+	// bookkeeping along; it starts over for each new state
+	s->releasePending = false;
+	s->numDeltaChildren = 0;
+	s->deltaParent = NULL;
+	s->frontierBound = 0.0;
+	s->boundIndexed = false;
+
+	if (tulipOutputFile)
+	{
+		fprintf(tulipOutputFile, "(nodes %lld)\n", s->id);
+		if (s->parID != -1) 
+			fprintf(tulipOutputFile, "(edge %lld %lld %lld)\n", nextEdgeID++, s->id, s->parID);
+		s->writeTulipOutput(tulipOutputFile);
+	}
+
+    while (s->depth >= tStats->numIdentifiedAtLevel.size()) 
+        tStats->numIdentifiedAtLevel.push_back(0);
+    ++tStats->numIdentifiedAtLevel[s->depth];
+    ++tStats->statesIdentified;
+    return;
+}
+
+void BTree::recordStoredState(State *s)
+{
+    // Store non-terminal, non-prunable state in the appropriate dominance 
+    // class, creating a new class if none currently exists for it.
+    if (retainStates) 
+    {
+        tStats->domStatesEvicted += domClasses.insert(s);
+        tStats->domMemoryBytes = domClasses.numBytesHeld();
     }
+
+    while (s->depth >= tStats->numStoredAtLevel.size()) 
+        tStats->numStoredAtLevel.push_back(0);
+    ++tStats->numStoredAtLevel[s->depth];
+    ++tStats->statesStoredInTree;
     return;
 }
 
+bool BTree::stateIsDuplicate(State *s)
+{
+    int result = transTable->lookup(s);
+    if (result == TT_HIT) 
+    {
+        ++tStats->transpositionHits;
+        if (debug >= 3) 
+            printf("State at depth %d is a duplicate\n", s->depth);
+        return true;
+    }
+    ++tStats->transpositionMisses;
+    if (result == TT_REPLACED) ++tStats->transpositionReplacements;
+    return false;
+}
+
+void BTree::compactState(State *s)
+{
+    // Only children of the state being branched on can refer to a parent
+    if ((curState == NULL) || !s->compact()) return;
+
+    s->deltaParent = curState;
+    ++curState->numDeltaChildren;
+    ++tStats->statesCompacted;
+    return;
+}
+
+void BTree::materializeState(State *s)
+{
+    s->materialize(s->deltaParent);
+    ++tStats->statesMaterialized;
+    dropParentRef(s);
+    return;
+}
+
+void BTree::dropParentRef(State *s)
+{
+    // Release the parent once its last compacted child no longer needs it
+    State* parent = s->deltaParent;
+    s->deltaParent = NULL;
+    if ((--parent->numDeltaChildren == 0) && parent->releasePending)
+    {
+        parent->releasePending = false;
+        releaseState(parent);
+    }
+    return;
+}
+
+// The live accounting brackets each state's stay in the tree, so a state's 
+// memoryUsage() must not change while it is stored
+void BTree::addLiveState(State *s)
+{
+    size_t bytes = s->memoryUsage();
+    while (s->depth >= tStats->numLiveAtLevel.size()) 
+    {
+        tStats->numLiveAtLevel.push_back(0);
+        tStats->liveBytesAtLevel.push_back(0);
+    }
+    ++tStats->numLiveAtLevel[s->depth];
+    tStats->liveBytesAtLevel[s->depth] += bytes;
+
+    ++tStats->liveStates;
+    tStats->liveBytes += bytes;
+    if (tStats->liveStates > tStats->peakLiveStates) 
+        tStats->peakLiveStates = tStats->liveStates;
+    if (tStats->liveBytes > tStats->peakLiveBytes) 
+        tStats->peakLiveBytes = tStats->liveBytes;
+
+    if (trackBestBound)
+    {
+        s->frontierBound = (problemType == MIN) ? s->lowerBound : s->upperBound;
+        s->boundIndexed = true;
+        frontierBounds.insert(s->frontierBound);
+    }
+    return;
+}
+
+void BTree::removeLiveState(State *s)
+{
+    size_t bytes = s->memoryUsage();
+    --tStats->numLiveAtLevel[s->depth];
+    tStats->liveBytesAtLevel[s->depth] -= bytes;
+    --tStats->liveStates;
+    tStats->liveBytes -= bytes;
+
+    // The state's bound may have changed since it was indexed
+    if (s->boundIndexed)
+    {
+        multiset<double>::iterator it = frontierBounds.find(s->frontierBound);
+        if (it != frontierBounds.end()) frontierBounds.erase(it);
+        s->boundIndexed = false;
+    }
+    return;
+}
+
+// Finds the best bound of the states waiting in the tree, from the bound 
+// index if there is one and otherwise from the tree's best-bound state.  
+// Returns false if no such bound is available.
+bool BTree::getFrontierBound(double &bound)
+{
+    if (trackBestBound)
+    {
+        if (frontierBounds.empty()) return false;
+        bound = (problemType == MIN) ? *frontierBounds.begin() : *frontierBounds.rbegin();
+        return true;
+    }
+    State* best = peekBestBoundState();
+    if (best == NULL) return false;
+    bound = (problemType == MIN) ? best->getLB() : best->getUB();
+    return true;
+}
+
+// Raises the global lower bound (MIN) or lowers the global upper bound (MAX)
+// to the best bound over the open states (or to the incumbent, within the 
+// pruning tolerance, once there are none).  While states are still being 
+// bounded by worker threads, the index does not cover them, so the global 
+// bound is left alone.
+void BTree::updateGlobalBound()
+{
+    double bound;
+    if (numPendingBounds > 0) return;
+    if (!getFrontierBound(bound))
+    {
+        // Once the tree is empty, every remaining state has been pruned by
+        // the incumbent (without one, the problem is infeasible and there
+        // is no bound to report)
+        if (!isEmpty() || (bestState == NULL)) return;
+        bound = (problemType == MIN) ? globalUpperBound : globalLowerBound;
+    }
+
+    // States within the pruning tolerance of the incumbent are only waiting
+    // to be pruned, so the bound proven so far is at most that close to it
+    double tol = pruneTolerance();
+    if (problemType == MIN)
+        globalLowerBound = std::max(globalLowerBound, std::min(bound, globalUpperBound - tol));
+    else // problemType == MAX
+        globalUpperBound = std::min(globalUpperBound, std::max(bound, globalLowerBound + tol));
+    return;
+}
+
+long long BTree::getNumLiveStatesAtLevel(int level) const
+{
+    if ((level < 0) || (level >= tStats->numLiveAtLevel.size())) return 0;
+    return tStats->numLiveAtLevel[level];
+}
+
+size_t BTree::getLiveBytesAtLevel(int level) const
+{
+    if ((level < 0) || (level >= tStats->liveBytesAtLevel.size())) return 0;
+    return tStats->liveBytesAtLevel[level];
+}
+
+size_t BTree::getMemoryUsage() const
+{
+    return tStats->liveBytes + domClasses.numBytesHeld() + tStats->bestStateBytes;
+}
+
+void BTree::discardState(State *s)
+{
+    // Used when clearing out the tree; s will never be explored
+    if (s->deltaParent) dropParentRef(s);
+    delete s;
+}
+
+void BTree::releaseState(State *s)
+{
+    if (s->deltaParent) dropParentRef(s);
+    if (s->numDeltaChildren > 0)
+    {
+        // Compacted children still need this state to materialize
+        s->releasePending = true;
+        return;
+    }
+
+    // Retained states stay in the dominance memory, which may drop them now 
+    // that they have left the tree; other states are no longer needed
+    if (retainStates) 
+    {
+        s->processed = true;
+
+        // Possibly keep just the state's dominance signature
+        DomSignature* sig = releaseExplored ? s->createDomSignature() : NULL;
+        if (sig)
+        {
+            sig->lowerBound = s->lowerBound;
+            sig->upperBound = s->upperBound;
+        }
+        if (domClasses.markExplored(s, sig))
+        {
+            ++tStats->statesReleasedAfterExploration;
+            delete s;
+        }
+        else delete sig;
+        tStats->domMemoryBytes = domClasses.numBytesHeld();
+    }
+    else delete s;
+}
+
+// Used by getNextState() for a state it passes over because it was 
+// dominated while waiting in the tree: the state leaves the frontier and is 
+// released the same way as a state pruned when it is selected
+void BTree::skipState(State *s)
+{
+    removeLiveState(s);
+    releaseState(s);
+}
+
 /*****************************************************************************/
 /* Pruning tests                                                             */
 /*****************************************************************************/
-inline
 bool BTree::stateIsPrunable(State *s)
 {
     // Apply standard dominance test. 
@@ -363,7 +1167,7 @@ bool BTree::stateIsDominated(State *s)
 		if (tulipOutputFile)
 		{
 			fprintf(tulipOutputFile, "(property 0 color \"viewColor\" ");
-			fprintf(tulipOutputFile, "(node %d \"(255, 0, 255, 255)\"))\n", s->id);
+			fprintf(tulipOutputFile, "(node %lld \"(255, 0, 255, 255)\"))\n", s->id);
 		}
         return true;
     } 
@@ -371,11 +1175,11 @@ bool BTree::stateIsDominated(State *s)
 	return false;
 }
 
-inline
 bool BTree::stateExceedsBounds(State *s)
 {
-    if (((problemType == MIN) && (s->getLB() >= globalUpperBound - eps)) ||
-        ((problemType == MAX) && (s->getUB() <= globalLowerBound + eps))) 
+    double tol = pruneTolerance();
+    if (((problemType == MIN) && (s->getLB() >= globalUpperBound - tol)) ||
+        ((problemType == MAX) && (s->getUB() <= globalLowerBound + tol))) 
 	{
         // NOTE: checks for pruning should be >= and <=, respectively. 
         // Changing them to > and < allows us to identify all optimal 
@@ -392,7 +1196,7 @@ bool BTree::stateExceedsBounds(State *s)
 		if (tulipOutputFile)
 		{
 			fprintf(tulipOutputFile, "(property 0 color \"viewColor\" ");
-			fprintf(tulipOutputFile, "(node %d \"(255, 0, 0, 255)\"))\n", s->id);
+			fprintf(tulipOutputFile, "(node %lld \"(255, 0, 0, 255)\"))\n", s->id);
 		}
         return true;
     }
@@ -400,6 +1204,17 @@ bool BTree::stateExceedsBounds(State *s)
 	return false;
 }
 
+// Returns how much a state must be able to improve on the incumbent to be 
+// worth exploring: eps, or the gap tolerances if they are larger
+double BTree::pruneTolerance() const
+{
+	double tol = std::max(eps, absGapTol);
+	double incumbent = (problemType == MIN) ? globalUpperBound : globalLowerBound;
+	if ((relGapTol > 0) && (fabs(incumbent) < std::numeric_limits<double>::max()))
+		tol = std::max(tol, relGapTol * fabs(incumbent));
+	return tol;
+}
+
 // Save the best state we've found so far
 void BTree::saveBestState(State* s, bool isTreeNode)
 {
@@ -421,6 +1236,7 @@ void BTree::saveBestState(State* s, bool isTreeNode)
 		{ 
 			++tStats->timesBestStateWasUpdated;
             bestState = s->clone();
+            tStats->bestStateBytes = bestState->memoryUsage();
             if (debug > 0)
                 printProgress(true);
         } 
@@ -432,6 +1248,7 @@ void BTree::saveBestState(State* s, bool isTreeNode)
         // We found a solution of better quality than the best known
         delete bestState;
         bestState = s->clone();
+        tStats->bestStateBytes = bestState->memoryUsage();
 
         if (problemType == MIN)
             globalUpperBound = objVal;
@@ -506,8 +1323,8 @@ void BTree::printProgress(bool newIncumbent) const
     } else {
         printf("  ");
     }
-    printf("Explored %10d/%d states: ", tStats->statesExplored, 
-                                        tStats->statesStoredInTree);
+    printf("Explored %10lld/%lld states: ", tStats->statesExplored.value(), 
+                                            tStats->statesStoredInTree.value());
     if (globalLowerBound > -std::numeric_limits<double>::max()) {
         printf("< %10.2f ", globalLowerBound);
     } else {
@@ -518,12 +1335,138 @@ void BTree::printProgress(bool newIncumbent) const
     } else {
         printf("|        Inf >");
     }
-    printf(" (%6.2fs) (TTB %6.2fs)\n", 
+    printf(" (%6.2fs) (TTB %6.2fs) [%lld live, %.1f MB]", 
             (clock() - runTimeStart) / CLOCKS_PER_SEC, 
-            (tStats->timeToOpt) / CLOCKS_PER_SEC);
+            (tStats->timeToOpt) / CLOCKS_PER_SEC,
+            tStats->liveStates, getMemoryUsage() / 1048576.0);
+    if (estimatedTimeLeft >= 0) 
+    {
+        // The estimate may predate the latest explored states
+        double treeSize = std::max(estimatedTreeSize, (double) tStats->statesExplored);
+        printf(" (est. %.0f%% of %.3g states, %.0fs left)", 
+                100.0 * tStats->statesExplored / treeSize, treeSize, 
+                estimatedTimeLeft);
+    }
+    if (estimatedGapTime >= 0) 
+        printf(" (gap closes in ~%.0fs)", estimatedGapTime);
+    printf("\n");
     return;
 }
 
+// Estimates the size of the whole tree from its depth profile, in the spirit
+// of Knuth's estimator with level averages in place of a random probe: the 
+// number of states explored at each level is the estimate for the level 
+// above, times the average number of children stored per explored state, 
+// times the fraction of the resolved states at the level that were explored
+// rather than pruned.  Levels that are finished contribute their exact 
+// counts.  The time left follows from the exploration rate so far, and the 
+// time to close the gap from the rate at which it has closed since an 
+// incumbent and a bound were first known.
+void BTree::updateProgressEstimate()
+{
+    const vector<long long>& explored = tStats->numExploredAtLevel;
+    const vector<long long>& stored = tStats->numStoredAtLevel;
+    double elapsed = tStats->totalTime / CLOCKS_PER_SEC;
+    long long numExplored = tStats->statesExplored;
+    if (explored.empty() || (numExplored == 0) || (elapsed <= 0)) return;
+
+    double levelSize = explored[0];
+    double total = levelSize;
+    for (int d = 1; (d < stored.size()) && (d <= explored.size()) && 
+                    (explored[d - 1] > 0); ++d)
+    {
+        long long numExploredHere = (d < explored.size()) ? explored[d] : 0;
+        long long numResolved = stored[d] - getNumLiveStatesAtLevel(d);
+        double fractionExplored = (numResolved > 0) ? 
+            (double) numExploredHere / numResolved : 1.0;
+        levelSize *= fractionExplored * stored[d] / explored[d - 1];
+        total += levelSize;
+    }
+    estimatedTreeSize = std::max(total, (double) numExplored);
+    estimatedTimeLeft = (estimatedTreeSize - numExplored) * elapsed / numExplored;
+
+    // The gap needs an incumbent and a tree that can report its best bound
+    double incumbent = (problemType == MIN) ? globalUpperBound : globalLowerBound;
+    double bound;
+    if (!getFrontierBound(bound) || (fabs(incumbent) >= std::numeric_limits<double>::max()) ||
+        ((bestState == NULL) && (incumbent == std::numeric_limits<double>::min())))
+        return;
+    double gap = fabs(incumbent - bound);
+    if (firstGapTime < 0)
+    {
+        firstGap = gap;
+        firstGapTime = elapsed;
+    }
+    else if ((gap < firstGap) && (elapsed > firstGapTime))
+        estimatedGapTime = gap * (elapsed - firstGapTime) / (firstGap - gap);
+    return;
+}
+
+// Builds a JSON snapshot of the search and hands it to the stats server. 
+// Returns false if the server was busy and the snapshot was dropped.
+bool BTree::publishStats()
+{
+    // Infinite values (e.g. missing bounds) are reported as null
+    auto number = [](double x) -> string 
+    {
+        if (!(fabs(x) < std::numeric_limits<double>::max())) return "null";
+        std::ostringstream out;
+        out.precision(12);
+        out << x;
+        return out.str();
+    };
+    bool haveIncumbent = (bestState != NULL) || 
+        ((problemType == MIN) ? (globalUpperBound < std::numeric_limits<double>::max()) :
+                                (globalLowerBound != std::numeric_limits<double>::min()));
+    double bound;
+    bool haveBound = getFrontierBound(bound);
+
+    std::ostringstream out;
+    out << "{\n";
+    out << "  \"tree\": \"" << name << "\",\n";
+    out << "  \"problemType\": \"" << ((problemType == MIN) ? "MIN" : "MAX") << "\",\n";
+    out << "  \"running\": " << ((keepExploring && !isEmpty()) ? "true" : "false") << ",\n";
+    out << "  \"statesIdentified\": " << tStats->statesIdentified << ",\n";
+    out << "  \"statesExplored\": " << tStats->statesExplored << ",\n";
+    out << "  \"statesStoredInTree\": " << tStats->statesStoredInTree << ",\n";
+    out << "  \"terminalStatesIdentified\": " << tStats->terminalStatesIdentified << ",\n";
+    out << "  \"statesPrunedByBounds\": " << 
+        tStats->statesPrunedByBoundsBeforeInsertion + 
+        tStats->statesPrunedByBoundsBeforeExploration << ",\n";
+    out << "  \"statesPrunedByDominance\": " << 
+        tStats->statesPrunedByDomBeforeInsertion + 
+        tStats->statesPrunedByDomBeforeExploration << ",\n";
+    out << "  \"statesPrunedAsDuplicates\": " << tStats->statesPrunedAsDuplicates << ",\n";
+    out << "  \"timesBestStateWasUpdated\": " << tStats->timesBestStateWasUpdated << ",\n";
+    out << "  \"globalLowerBound\": " << 
+        ((problemType == MAX && !haveIncumbent) ? "null" : number(globalLowerBound)) << ",\n";
+    out << "  \"globalUpperBound\": " << number(globalUpperBound) << ",\n";
+    out << "  \"bestBoundInTree\": " << (haveBound ? number(bound) : "null") << ",\n";
+    out << "  \"liveStates\": " << tStats->liveStates << ",\n";
+    out << "  \"peakLiveStates\": " << tStats->peakLiveStates << ",\n";
+    out << "  \"liveBytes\": " << tStats->liveBytes << ",\n";
+    out << "  \"peakLiveBytes\": " << tStats->peakLiveBytes << ",\n";
+    out << "  \"memoryBytes\": " << getMemoryUsage() << ",\n";
+    out << "  \"liveStatesAtLevel\": [";
+    for (int i = 0; i < tStats->numLiveAtLevel.size(); ++i)
+        out << ((i > 0) ? ", " : "") << tStats->numLiveAtLevel[i];
+    out << "],\n";
+    out << "  \"estimatedTreeSize\": " << number(estimatedTreeSize) << ",\n";
+    out << "  \"estimatedTimeLeft\": " << 
+        ((estimatedTimeLeft < 0) ? "null" : number(estimatedTimeLeft)) << ",\n";
+    out << "  \"estimatedGapClosingTime\": " << 
+        ((estimatedGapTime < 0) ? "null" : number(estimatedGapTime)) << ",\n";
+    out << "  \"cpuTime\": " << number(tStats->totalTime / CLOCKS_PER_SEC) << ",\n";
+    out << "  \"timeToOpt\": " << number(tStats->timeToOpt / CLOCKS_PER_SEC) << ",\n";
+    out << "  \"branchingTime\": " << number(tStats->branchingTime) << ",\n";
+    out << "  \"boundingTime\": " << number(tStats->boundingTime) << ",\n";
+    out << "  \"dominanceTime\": " << number(tStats->dominanceTime) << "\n";
+    out << "}\n";
+
+    string snapshot = out.str();
+    return statsServer->tryPublish(snapshot);
+}
+
 /*****************************************************************************/
 /* TreeStats function definitions                                            */
 /*****************************************************************************/
@@ -539,15 +1482,49 @@ TreeStats::TreeStats()
     statesPrunedByBoundsBeforeExploration = 0;
     statesPrunedByDomBeforeInsertion = 0;
     statesPrunedByDomBeforeExploration = 0;
+    statesPrunedAsDuplicates = 0;
+    statesReleasedAfterExploration = 0;
+    domStatesEvicted = 0;
+    statesCheckedAfterEviction = 0;
+
+    transpositionHits = 0;
+    transpositionMisses = 0;
+    transpositionReplacements = 0;
 
     timesBestStateWasUpdated = 0;
     statesIdentifiedAtLastUpdate = 0;
     statesStoredInTreeAtLastUpdate = 0;
     statesExploredAtLastUpdate = 0;
 
+    divesPerformed = 0;
+    diveStatesExplored = 0;
+    diveImprovements = 0;
+
+    statesCompacted = 0;
+    statesMaterialized = 0;
+
+    boundComputationsDeferred = 0;
+    deferredBoundsComputed = 0;
+    statesReinsertedAfterBounding = 0;
+
+    liveStates = 0;
+    peakLiveStates = 0;
+    liveBytes = 0;
+    peakLiveBytes = 0;
+    domMemoryBytes = 0;
+    bestStateBytes = 0;
+
     numOptimalTerminalStatesIdentified = 0;
     numOptimalHeuristicStatesProcessed = 0;
 	totalTime = 0;
+	timeToOpt = 0;
+
+    externalStatesSubmitted = 0;
+    externalStatesRejected = 0;
+
+    branchingTime = 0;
+    boundingTime = 0;
+    dominanceTime = 0;
 }
 
 TreeStats::~TreeStats()
@@ -558,35 +1535,86 @@ TreeStats::~TreeStats()
 void TreeStats::print() const
 {
     printf("Search statistics:\n------------------\n");
-    printf("%d states were identified\n", statesIdentified);
-    printf("%d states were explored\n", statesExplored);
-    printf("%d states were stored in the tree\n", statesStoredInTree);
-    printf("%d terminal states were identified\n", terminalStatesIdentified);
-    printf("%d heuristic states were processed\n", heuristicStatesProcessed);
-    printf("%d updates of the best state performed\n\n", 
+    printf("%lld states were identified\n", statesIdentified.value());
+    printf("%lld states were explored\n", statesExplored.value());
+    printf("%lld states were stored in the tree\n", statesStoredInTree.value());
+    printf("%lld terminal states were identified\n", terminalStatesIdentified.value());
+    printf("%lld heuristic states were processed\n", heuristicStatesProcessed);
+    if (externalStatesSubmitted > 0)
+        printf("%lld solutions were submitted by other threads (%lld rejected)\n", 
+                externalStatesSubmitted, externalStatesRejected);
+    printf("%lld updates of the best state performed\n\n", 
             timesBestStateWasUpdated);
+    if (divesPerformed > 0)
+    {
+        printf("Diving statistics:\n------------------\n");
+        printf("%lld dives were performed\n", divesPerformed);
+        printf("%lld states were explored while diving\n", diveStatesExplored);
+        printf("%lld dives improved the best state\n\n", diveImprovements);
+    }
+    if (statesCompacted > 0)
+    {
+        printf("%lld states were stored delta-encoded (%lld materialized)\n\n", 
+                statesCompacted, statesMaterialized);
+    }
     printf("Bounds statistics:\n------------------\n");
-    printf("%d states were pruned by bounds before insertion\n", 
-            statesPrunedByBoundsBeforeInsertion);
-    printf("%d states were pruned by bounds before exploration\n\n", 
-            statesPrunedByBoundsBeforeExploration);
+    printf("%lld states were pruned by bounds before insertion\n", 
+            statesPrunedByBoundsBeforeInsertion.value());
+    printf("%lld states were pruned by bounds before exploration\n", 
+            statesPrunedByBoundsBeforeExploration.value());
+    printf("%lld bound computations were deferred (%lld performed later)\n", 
+            boundComputationsDeferred, deferredBoundsComputed);
+    printf("%lld states were reinserted after computing their bounds\n\n", 
+            statesReinsertedAfterBounding);
     printf("Dominance statistics:\n---------------------\n");
-    printf("%d states were pruned by dominance rules before insertion\n", 
-            statesPrunedByDomBeforeInsertion);
-    printf("%d states were pruned by dominance rules before exploration\n\n", 
-            statesPrunedByDomBeforeExploration);
+    printf("%lld states were pruned by dominance rules before insertion\n", 
+            statesPrunedByDomBeforeInsertion.value());
+    printf("%lld states were pruned by dominance rules before exploration\n", 
+            statesPrunedByDomBeforeExploration.value());
+    if (statesReleasedAfterExploration > 0)
+        printf("%lld explored states were replaced by dominance signatures\n", 
+                statesReleasedAfterExploration);
+    if (domStatesEvicted > 0)
+    {
+        printf("%lld states were evicted from the dominance memory\n", 
+                domStatesEvicted);
+        printf("%lld states passed dominance checks in classes with evicted "
+               "states (upper bound on lost pruning)\n", statesCheckedAfterEviction);
+    }
+    printf("\n");
+    if (transpositionHits + transpositionMisses > 0)
+    {
+        printf("Transposition table statistics:\n-------------------------------\n");
+        printf("%lld states were pruned as duplicates\n", statesPrunedAsDuplicates.value());
+        printf("%lld hits, %lld misses, %lld replacements\n\n", 
+                transpositionHits, transpositionMisses, transpositionReplacements);
+    }
+    if (branchingTime + boundingTime + dominanceTime > 0)
+    {
+        printf("Phase timings:\n--------------\n");
+        printf("%.2fs branching, %.2fs bounding, %.2fs checking dominance\n\n", 
+                branchingTime, boundingTime, dominanceTime);
+    }
+    printf("Memory statistics:\n------------------\n");
+    printf("%lld states were waiting in the tree at the peak (%.1f MB)\n", 
+            peakLiveStates, peakLiveBytes / 1048576.0);
+    printf("%lld states (%.1f MB) are still waiting in the tree\n", 
+            liveStates, liveBytes / 1048576.0);
+    printf("%.1f MB are held by the dominance memory\n", 
+            domMemoryBytes / 1048576.0);
+    printf("%.1f KB are held by the best state\n\n", bestStateBytes / 1024.0);
     printf("Optimality Statistics:\n----------------------\n");
-    printf("%d optimal terminal states found\n", 
+    printf("%lld optimal terminal states found\n", 
             numOptimalTerminalStatesIdentified);
-    printf("%d optimal heuristic solutions processed\n\n", 
+    printf("%lld optimal heuristic solutions processed\n\n", 
             numOptimalHeuristicStatesProcessed);
-    printf("%d states were identified when the optimal solution was found\n", 
+    printf("%lld states were identified when the optimal solution was found\n", 
             statesIdentifiedAtLastUpdate);
-    printf("%d states had been stored in the tree when the optimal solution "
+    printf("%lld states had been stored in the tree when the optimal solution "
            "was found\n", statesStoredInTreeAtLastUpdate);
-    printf("%d states were explored when the optimal solution was found\n", 
+    printf("%lld states were explored when the optimal solution was found\n", 
             statesExploredAtLastUpdate);
-    printf("%d = %d - %d states remained in tree when optimal solution was "
+    printf("%lld = %lld - %lld states remained in tree when optimal solution was "
            "found\n\n", 
             statesStoredInTreeAtLastUpdate - statesExploredAtLastUpdate, 
             statesStoredInTreeAtLastUpdate, statesExploredAtLastUpdate);
@@ -595,7 +1623,7 @@ void TreeStats::print() const
     if (numIdentifiedAtLevel.size() > 0)
     {
         printf("Identified states at level:\n");
-        printf("{%d", numIdentifiedAtLevel[0]);
+        printf("{%lld", numIdentifiedAtLevel[0]);
         int zeroCount = 0;
         for (int i = 1; i < numIdentifiedAtLevel.size(); ++i)
         {
@@ -605,7 +1633,7 @@ void TreeStats::print() const
                 if (zeroCount > 0)
                     printf(", <%d empty levels>", zeroCount);
                 zeroCount = 0;
-                printf(", %d", numIdentifiedAtLevel[i]);
+                printf(", %lld", numIdentifiedAtLevel[i]);
             }
         }
         printf("};\n");
@@ -613,7 +1641,7 @@ void TreeStats::print() const
     if (numExploredAtLevel.size() > 0)
     {
         printf("Explored states at level:\n");
-        printf("{%d", numExploredAtLevel[0]);
+        printf("{%lld", numExploredAtLevel[0]);
         int zeroCount = 0;
         for (int i = 1; i < numExploredAtLevel.size(); ++i)
         {
@@ -623,7 +1651,7 @@ void TreeStats::print() const
                 if (zeroCount > 0)
                     printf(", <%d empty levels>", zeroCount);
                 zeroCount = 0;
-                printf(", %d", numExploredAtLevel[i]);
+                printf(", %lld", numExploredAtLevel[i]);
             }
         }
         printf("};\n");
@@ -631,7 +1659,7 @@ void TreeStats::print() const
     if (numStoredAtLevel.size() > 0)
     {
         printf("Stored states at level:\n");
-        printf("{%d", numStoredAtLevel[0]);
+        printf("{%lld", numStoredAtLevel[0]);
         int zeroCount = 0;
         for (int i = 1; i < numStoredAtLevel.size(); ++i)
         {
@@ -641,7 +1669,7 @@ void TreeStats::print() const
                 if (zeroCount > 0)
 					printf(", <%d empty levels>", zeroCount);
                 zeroCount = 0;
-                printf(", %d", numStoredAtLevel[i]);
+                printf(", %lld", numStoredAtLevel[i]);
             }
         }
         printf("};\n");
@@ -13,8 +13,11 @@
 using std::vector;
 #include <list>
 using std::list;
+#include <set>
+using std::multiset;
 #include <queue>
 using std::priority_queue;
+#include <algorithm>
 #include <unordered_map>
 using std::unordered_map;
 #include <exception>
@@ -23,6 +26,13 @@ using std::exception;
 #include <limits>
 #include <string>
 using std::string;
+#include <mutex>
+#include <condition_variable>
+#include <random>
+
+#include "counter.h"
+#include "domregistry.h"
+#include "searchcontrol.h"
 
 // Global definitions
 #define CBFS_ALG 0x01
@@ -40,12 +50,75 @@ const double eps = 10e-05;
 // Forward Declarations
 class State;
 struct StateComparator;
+class ThreadPool;
+class TranspositionTable;
+class StatsServer;
 //class SortStatePriority;
 
+// Priority queue that also supports inserting or removing a whole batch of 
+// elements at once; a large batch is appended and heapified in a single pass
+// instead of being sifted up element by element.
+template <typename T, typename Compare>
+class batch_priority_queue : public priority_queue<T, vector<T>, Compare>
+{
+  public:
+    using priority_queue<T, vector<T>, Compare>::push;
+
+    template <typename InputIt>
+    void push(InputIt first, InputIt last)
+    {
+        size_t oldSize = this->c.size();
+        this->c.insert(this->c.end(), first, last);
+        if (this->c.size() - oldSize > oldSize / 2)
+            std::make_heap(this->c.begin(), this->c.end(), this->comp);
+        else
+        {
+            for (auto it = this->c.begin() + oldSize + 1; it <= this->c.end(); ++it)
+                std::push_heap(this->c.begin(), it, this->comp);
+        }
+    }
+
+    // Removes the best k elements (all of them if there are fewer), best 
+    // first.  Popping them one at a time costs O(k log n); once that is more
+    // than the O(n) of partitioning the storage and rebuilding the heap, 
+    // they are taken out in bulk instead.
+    void pop_best(size_t k, vector<T>& out)
+    {
+        size_t n = this->c.size();
+        size_t logN = 1;
+        for (size_t m = n; m > 1; m >>= 1) ++logN;
+        if ((k < n) && (k * logN < n))
+        {
+            for (size_t i = 0; i < k; ++i)
+            {
+                out.push_back(this->top());
+                this->pop();
+            }
+            return;
+        }
+
+        Compare comp = this->comp;
+        auto better = [&comp](const T& x, const T& y) { return comp(y, x); };
+        size_t numTaken = std::min(k, n);
+        std::nth_element(this->c.begin(), this->c.begin() + numTaken, 
+                         this->c.end(), better);
+        std::sort(this->c.begin(), this->c.begin() + numTaken, better);
+        out.insert(out.end(), this->c.begin(), this->c.begin() + numTaken);
+        this->c.erase(this->c.begin(), this->c.begin() + numTaken);
+        std::make_heap(this->c.begin(), this->c.end(), this->comp);
+    }
+
+    // Removes every element at once (in no particular order)
+    void take_all(vector<T>& out)
+    {
+        out.insert(out.end(), this->c.begin(), this->c.end());
+        this->c.clear();
+    }
+};
+
 // Typedef's for various data structures
-typedef list<State*> DomClass;
-typedef priority_queue<State*, vector<State*>, StateComparator> state_priority_queue;
-typedef unordered_map<int, DomClass *> dominance_class_map;
+typedef batch_priority_queue<State*, StateComparator> state_priority_queue;
+typedef DominanceRegistry dominance_class_map;
 
 // Used for tracking search statistics
 struct TreeStats
@@ -54,32 +127,74 @@ struct TreeStats
     virtual ~TreeStats();
     virtual void print() const;
 
-    // Variables for TreeStats
-    int statesIdentified;
-    int statesExplored;
-    int statesStoredInTree;
-    int terminalStatesIdentified;
-    int heuristicStatesProcessed;
-
-    int statesPrunedByBoundsBeforeInsertion;
-    int statesPrunedByBoundsBeforeExploration;
-    int statesPrunedByDomBeforeInsertion;
-    int statesPrunedByDomBeforeExploration;
-
-    int timesBestStateWasUpdated;
-    int statesIdentifiedAtLastUpdate;
-    int statesExploredAtLastUpdate;
-    int statesStoredInTreeAtLastUpdate;
-
-	int numOptimalTerminalStatesIdentified;
-    int numOptimalHeuristicStatesProcessed;
+    // Variables for TreeStats.  The counters updated for every state are 
+    // sharded per thread (see ShardedCounter); the rest are plain 64-bit.
+    ShardedCounter statesIdentified;
+    ShardedCounter statesExplored;
+    ShardedCounter statesStoredInTree;
+    ShardedCounter terminalStatesIdentified;
+    long long heuristicStatesProcessed;
+    long long externalStatesSubmitted; // Through SearchControl::submitSolution
+    long long externalStatesRejected;
+
+    ShardedCounter statesPrunedByBoundsBeforeInsertion;
+    ShardedCounter statesPrunedByBoundsBeforeExploration;
+    ShardedCounter statesPrunedByDomBeforeInsertion;
+    ShardedCounter statesPrunedByDomBeforeExploration;
+    ShardedCounter statesPrunedAsDuplicates;
+    long long statesReleasedAfterExploration;
+    long long domStatesEvicted;
+    long long statesCheckedAfterEviction;
+
+    long long transpositionHits;
+    long long transpositionMisses;
+    long long transpositionReplacements;
+
+    long long timesBestStateWasUpdated;
+    long long statesIdentifiedAtLastUpdate;
+    long long statesExploredAtLastUpdate;
+    long long statesStoredInTreeAtLastUpdate;
+
+    long long divesPerformed;
+    long long diveStatesExplored;
+    long long diveImprovements;
+
+    long long statesCompacted;
+    long long statesMaterialized;
+
+    long long boundComputationsDeferred;
+    long long deferredBoundsComputed;
+    long long statesReinsertedAfterBounding;
+
+    // Live memory accounting (State::memoryUsage): states currently waiting
+    // in the tree, explored states and signatures kept in the dominance 
+    // memory, and the incumbent
+    long long liveStates;
+    long long peakLiveStates;
+    size_t liveBytes;
+    size_t peakLiveBytes;
+    size_t domMemoryBytes;
+    size_t bestStateBytes;
+
+	long long numOptimalTerminalStatesIdentified;
+    long long numOptimalHeuristicStatesProcessed;
 
 	double totalTime;
     double timeToOpt;
 
-	vector<int> numIdentifiedAtLevel;
-	vector<int> numExploredAtLevel;
-	vector<int> numStoredAtLevel;
+    // Seconds spent in each phase of the search, measured only when phase 
+    // timing is on (BTree::setPhaseTiming).  Branching excludes the bounding
+    // and dominance checks of the children it creates; bounds computed by 
+    // worker threads are not included.
+    double branchingTime;
+    double boundingTime;
+    double dominanceTime;
+
+	vector<long long> numIdentifiedAtLevel;
+	vector<long long> numExploredAtLevel;
+	vector<long long> numStoredAtLevel;
+	vector<long long> numLiveAtLevel;
+	vector<size_t> liveBytesAtLevel;
 };
 
 class AbortException : public std::exception
@@ -102,6 +217,15 @@ class BTree
 	// Returns true if terminal or inserted into tree.  Returns false if pruned by dominance
 	// or bounds.  I'm not sure if this is the best behaviour or not.  TODO
     bool processState(State *s, bool isRoot = false);
+
+	// Processes all children of a state at once.  Terminal states are handled
+	// immediately, the remaining states are checked for dominance (against
+	// memory and against each other), bounded together, and the survivors are
+	// inserted into the tree with a single bulk operation.  Bounds are not
+	// computed here when states set their own bounds during branch()
+	// (setStateComputesBounds).  Returns the number of states inserted into
+	// the tree (or handed to the bounding threads).
+    int processStates(vector<State*>& states);
     void processHeuristicState(State *s);
     bool attemptHeuristicCompletion(State *s);
 	void resetBest();
@@ -110,25 +234,135 @@ class BTree
     void setDebug(int level) { debug = level; }
     void setDomUsage(bool b) { useDom = b; }
     void setRetainStates(bool b) { retainStates = b; }
+
+	// Caps the dominance memory (retained states) per dominance class and in 
+	// total (0 means no limit).  When a limit is exceeded, an already explored
+	// state is dropped according to the policy (EVICT_OLDEST, 
+	// EVICT_WORST_BOUND or EVICT_LEAST_RECENTLY_DOMINATING) and deleted.
+	// States are retained (setRetainStates) so that they can dominate, but 
+	// also so that they stay valid for as long as the tree exists; with 
+	// limits set, an explored state may be deleted at any time, so states 
+	// must not keep pointers to their explored ancestors.
+	void setDomMemoryLimits(int maxPerClass, int maxTotal, int policy = EVICT_OLDEST)
+		{ domClasses.setLimits(maxPerClass, maxTotal, policy, problemType); }
+
+	// Once a retained state has been explored, keep only its dominance 
+	// signature (State::createDomSignature) and delete the full state.  Not 
+	// suitable if children keep pointers to their parents.
+	void setReleaseExplored(bool b) { releaseExplored = b; }
+
+	// Store children delta-encoded from their parent (see State::compact and
+	// State::materialize); the parent is kept alive until all of its 
+	// compacted children have been materialized or discarded.
+	void setDeltaEncoding(bool b) { deltaEncoding = b; }
     void setFinalTestUsage(bool b) { useFinalTests = b; }
 	void setFindAllSolns(bool b) {findAllSolns = b; }
 	void setSaveNonTermStates(bool b) {saveNonTerm = b; }
-    void setNodeLimit(int lim) { nodeLimit = lim; }
+    void setNodeLimit(long long lim) { nodeLimit = lim; }
     void setTimeLimit(double lim) { timeLimit = lim * CLOCKS_PER_SEC; }
     void setFirstImprovStop(bool b) { stopAtFirstImprov = b; }
+
+	// Accept solutions within an optimality gap: states that cannot improve 
+	// on the incumbent by more than max(absGap, relGap * |incumbent|) are 
+	// pruned, and the search stops once the gap between the global bounds 
+	// is that small (e.g. relGap = 0.001 for a 0.1% gap).  Both default to 0,
+	// which leaves only the fixed tolerance eps.
+	void setGapTolerance(double relGap, double absGap = 0.0) { relGapTol = relGap; absGapTol = absGap; }
 	void setOutputRate(int rate) { outputRate = rate; }
+
+	// Every <rate> explored states (0 disables it), re-estimate the size of 
+	// the whole tree and the time left to explore it (see 
+	// updateProgressEstimate).  The estimates appear in the progress output.
+	void setEstimateRate(int rate) { estimateRate = rate; }
 	void setStartTime(double time) { tStats->totalTime = time; tStats->timeToOpt = time;}
 	void setGlobalLB(double lb) { globalLowerBound = lb; }
 	void setGlobalUB(double ub) { globalUpperBound = ub; }
 	void setStateComputesBounds(bool b) { stateComputesBounds = b; }
+
+	// When numThreads > 0, bounds of newly identified states are computed 
+	// asynchronously by a pool of worker threads, and only bounded, surviving 
+	// states enter the tree.  computeBounds() must then be thread-safe and 
+	// must not call back into the tree; dominance is only checked against 
+	// states already in the tree, and processState() returns true for states
+	// handed off to the pool.
+	void setBoundThreads(int numThreads);
+
+	// Makes runs with bounding threads reproducible: bounds are collected in
+	// rounds of <roundSize> explored states, waiting for every bound of the 
+	// round, and the states enter the tree in the order they were identified
+	// rather than the order the threads finished them.  The node order, the 
+	// incumbents and the statistics then only depend on the seed (time 
+	// limits and requests through getControl() aside).
+	void setDeterministic(bool b, int roundSize = 64) { deterministic = b; boundRoundSize = roundSize; }
+
+	// Seeds the tree's random number generator (used e.g. by CBFSTree's 
+	// RANDOM_FROM_TOP_K selection)
+	void setSeed(unsigned long long seed) { rng.seed(seed); }
+
+	// In lazy bounding mode, non-root states are stored with their parent's 
+	// bound and computeBounds() is only called when they are selected for 
+	// exploration; a state whose real bound differs is put back in the tree.
+	void setLazyBounds(bool b) { lazyBounds = b; }
+
+	// Every <frequency> explored states, take the best-bound state in the tree
+	// and greedily dive below a copy of it (always following the child with 
+	// the highest priority, without storing any siblings) for at most 
+	// <maxDepth> levels, looking for a better incumbent.  Only trees that can 
+	// report their best-bound state (BFSTree and CBFSTree) support diving.
+	void setDiving(int frequency, int maxDepth) { diveFrequency = frequency; diveMaxDepth = maxDepth; }
+
+	// Keeps copies of up to <maxEntries> identified states in a hashed 
+	// transposition table (0 disables it); a new state equivalent to one in 
+	// the table (see State::hashKey and State::isEquivalent) is pruned as a 
+	// duplicate before it is bounded.  The capacity is rounded down to a 
+	// power of two times TT_BUCKET_SIZE.
+	void setTranspositionTable(size_t maxEntries);
 	void setTulipOutputFile(const char* filename, const char* instName, long seed, bool deep);
 
+	// Serves a JSON snapshot of the search (counters, bounds, frontier sizes,
+	// estimates and phase timings) to clients of a Unix domain socket at 
+	// <socketPath>; the snapshot is refreshed every <publishRate> explored 
+	// states (which must be positive) without ever blocking the search.  
+	// NULL stops the server.  Also turns on phase timing.
+	void setStatsServer(const char* socketPath, int publishRate = 1000);
+
+	// Keep an index of the bounds of all states in the tree, so that the 
+	// global bound (the lower bound for MIN problems, the upper bound for 
+	// MAX) improves as the search proceeds rather than only at the root.  
+	// Off by default; must be set before any state is stored in the tree.
+	void setBestBoundTracking(bool b);
+
+	// Measure the time spent branching, bounding and checking dominance
+	void setPhaseTiming(bool b) { phaseTiming = b; }
+
+	// Thread-safe handle for stopping, pausing or tightening a running 
+	// explore() from other threads, and for submitting their solutions
+	SearchControl& getControl() { return control; }
+
 	// Getters
     State* getOptSolution() { return bestState; }
 	double getGlobalLB() { return globalLowerBound; }
 	double getGlobalUB() { return globalUpperBound; }
 	const char* getName() { return name.c_str(); }
-	int getNumExploredStates() { return tStats->statesExplored; }
+	long long getNumExploredStates() { return tStats->statesExplored; }
+
+	// Live memory accounting, based on State::memoryUsage().  The tree's 
+	// frontier is measured when states are inserted and removed; 
+	// getMemoryUsage() adds the dominance memory and the incumbent.
+	long long getNumLiveStates() const { return tStats->liveStates; }
+	long long getPeakLiveStates() const { return tStats->peakLiveStates; }
+	size_t getLiveBytes() const { return tStats->liveBytes; }
+	size_t getPeakLiveBytes() const { return tStats->peakLiveBytes; }
+	long long getNumLiveStatesAtLevel(int level) const;
+	size_t getLiveBytesAtLevel(int level) const;
+	size_t getDomMemoryBytes() const { return domClasses.numBytesHeld(); }
+	size_t getMemoryUsage() const;
+
+	// Latest progress estimates; times are in seconds and negative while 
+	// there is not enough information
+	double getEstimatedTreeSize() const { return estimatedTreeSize; }
+	double getEstimatedTimeLeft() const { return estimatedTimeLeft; }
+	double getEstimatedGapClosingTime() const { return estimatedGapTime; }
 
     // Public printing functions
     void printOptSolution() const;
@@ -143,23 +377,38 @@ class BTree
     bool keepExploring;
 	bool isOptIntegral;
 	double runTimeStart;
-	int nextNodeID, nextEdgeID;
-	int exploredStates;
+	long long nextNodeID, nextEdgeID;
+	long long exploredStates;
+	State* curState; // State currently being branched on, if any
+	bool diving;
+	vector<State*> diveChildren;
+	long long nextDiveAt;
+	long long lastDiveStartID;
 	FILE* tulipOutputFile;
 
     // Parameters / Options
     int debug;
     bool useDom;
     bool retainStates;
+    bool releaseExplored;
+    bool deltaEncoding;
     bool useFinalTests;
 	bool findAllSolns;
 	int outputRate;
+	int estimateRate;
+	bool phaseTiming;
+	bool trackBestBound;
 	bool stateComputesBounds;
+	bool lazyBounds;
+	int diveFrequency;
+	int diveMaxDepth;
 
     // Termination options
-    int nodeLimit; 
+    long long nodeLimit; 
     double timeLimit;
     bool stopAtFirstImprov;
+    double relGapTol;
+    double absGapTol;
 	bool saveNonTerm;
 
 	string name;
@@ -167,20 +416,88 @@ class BTree
     // For tracking search statistics
     TreeStats *tStats;
 
-    // This is an unordered map that maps a dominance class ID to a specific 
+    // Progress estimation
+    long long nextEstimateAt;
+    double estimatedTreeSize;
+    double estimatedTimeLeft;
+    double estimatedGapTime;
+    double firstGap; // Gap and time when an incumbent and a bound first 
+    double firstGapTime; // became available (negative until then)
+
+    // Asynchronous bounding pipeline: states waiting for (or done with) 
+    // their bound computation on the worker threads
+    ThreadPool *boundPool;
+    std::mutex boundMutex;
+    std::condition_variable boundCond;
+    vector<State*> boundedStates;
+    vector<State*> abortedStates; // Bounding threw an AbortException
+    int numPendingBounds;
+    bool boundAborted;
+    bool deterministic;
+    int boundRoundSize;
+    long long nextRoundAt;
+
+    // Random number generator owned by this tree, so that runs are 
+    // reproducible for a given seed
+    std::mt19937_64 rng;
+
+    // Table of previously seen states for duplicate detection
+    TranspositionTable *transTable;
+
+    // Bounds of the states waiting in the tree (see setBestBoundTracking)
+    multiset<double> frontierBounds;
+
+    // Requests from other threads, applied between explored states
+    SearchControl control;
+
+    // Introspection server and how often its snapshot is refreshed
+    StatsServer *statsServer;
+    int statsPublishRate;
+    long long nextPublishAt;
+
+    // This is a registry that maps a dominance class ID to a specific 
     // dominance class, implemented as a list of states. The dominance class 
     // ID for a state should be chosen such that any two states that may 
-    // potentially dominate each other should have the same ID. 
+    // potentially dominate each other should have the same ID.  The registry
+    // is sharded by class ID, so dominance rules can be applied from 
+    // several threads at once.
     dominance_class_map domClasses;
 
+    // Selects, checks and branches on the next state in the tree.  Engines 
+    // that do not store states (e.g. UndoDFSTree) override this to take one 
+    // step of their own search.
+    virtual void exploreNextState();
+
     // Implemented class functions that cannot be overridden by subclasses
-    void exploreNextState();
     void processTerminalState(State *s, bool isTreeNode = true);
     void applyDominanceRules(State *s);
+    void identifyState(State *s);
+    bool stateIsDuplicate(State *s);
+    void recordStoredState(State *s);
+    void submitForBounding(State *s);
+    void collectBoundedStates(bool wait);
+    void deferBounds(State *s);
+    bool computeDeferredBounds(State *s);
+    void dive(State *start);
+    bool processDiveState(State *s);
+
+    void addLiveState(State *s);
+    void removeLiveState(State *s);
+    bool getFrontierBound(double &bound);
+    void updateGlobalBound();
+
+    void releaseState(State *s);
+    void discardState(State *s);
+    void skipState(State *s);
+    void compactState(State *s);
+    void materializeState(State *s);
+    void dropParentRef(State *s);
 
     bool stateIsPrunable(State *s);
     bool stateIsDominated(State *s);
     bool stateExceedsBounds(State *s);
+    double randomFraction() { return (rng() >> 11) * (1.0 / 9007199254740992.0); }
+    double pruneTolerance() const;
 
 	void saveBestState(State* s, bool isTreeNode);
 
@@ -189,7 +506,23 @@ class BTree
     virtual State* getNextState() = 0;
     virtual void saveStateForExploration(State *s) = 0;
 
+	// Inserts a batch of states into the tree; subclasses whose frontier
+	// supports a cheaper bulk insertion should override this
+    virtual void saveStatesForExploration(vector<State*>& states);
+
+	// Returns the state in the tree with the best bound without removing it, 
+	// or NULL if the tree cannot determine it cheaply (disables diving)
+    virtual State* peekBestBoundState() { return NULL; }
+
+	// Whether the tree deleted states that could still have improved on the
+	// incumbent (e.g. a BeamTree), so that running out of states does not 
+	// prove optimality
+    virtual bool droppedStates() const { return false; }
+
     void printProgress(bool newIncumbent = false) const;
+    void updateProgressEstimate();
+    bool publishStats();
+    bool applyControlRequests();
 
   private:
     // Nothing
@@ -20,8 +20,9 @@ CBFSTree::CBFSTree(int probType, bool isIntProb, int selMethod, int k) :
 	BTree(probType, isIntProb),
 	selectionMethod(selMethod),
 	numToSelect(k),
-	numExploredAtCurLevel(0),
-	lastLevelExplored(-1)
+	thresholdFunc(NULL),
+	lastLevelExplored(-1),
+	nextInBatch(0)
 {
 	name = "*** CBFS ***";
     cbfsStats = new CBFSTreeStats();
@@ -37,15 +38,19 @@ CBFSTree::~CBFSTree()
 		while (!isEmpty()) 
 		{
 		   State *ns = getNextState();
-		   delete ns;
+		   discardState(ns);
 		}
 	}
 
     // Calls BTree destructor by default
-    // Now deletes all allocated priority queues for the different levels
+    // Now deletes all allocated priority queues for the different levels 
+    // (only one of the two kinds is used, depending on the selection method)
     for (int i = 0; i < unexploredStates.size(); ++i) {
         delete unexploredStates[i];
     }
+    for (int i = 0; i < rankedStates.size(); ++i) {
+        delete rankedStates[i];
+    }
 
 }
 
@@ -69,8 +74,9 @@ State *CBFSTree::getNextState()
 
 State *CBFSTree::getNextStateStandard()
 {
-    state_priority_queue* nextLevelSPQ = nonEmptyLevelSPQs.front();
-    nonEmptyLevelSPQs.pop_front();
+    int level = nonEmptyLevels.front();
+    nonEmptyLevels.pop_front();
+    state_priority_queue* nextLevelSPQ = unexploredStates[level];
 
     State* nextState = nextLevelSPQ->top();
     nextLevelSPQ->pop();
@@ -79,7 +85,7 @@ State *CBFSTree::getNextStateStandard()
 	{
         if ((*nextLevelSPQ).empty()) 
 		{
-            if (nonEmptyLevelSPQs.empty()) 
+            if (nonEmptyLevels.empty()) 
 			{
                 // No new states to explore except current dominated one, 
                 // so return it to tree's exploreNextState function for 
@@ -87,16 +93,18 @@ State *CBFSTree::getNextStateStandard()
                 lastLevelExplored = nextState->getDepth();
                 return nextState;
             }
-            nextLevelSPQ = nonEmptyLevelSPQs.front();
-            nonEmptyLevelSPQs.pop_front();
+            level = nonEmptyLevels.front();
+            nonEmptyLevels.pop_front();
+            nextLevelSPQ = unexploredStates[level];
         }
+        skipState(nextState);
         nextState = (*nextLevelSPQ).top();
         (*nextLevelSPQ).pop();
     }
 
     if (!(*nextLevelSPQ).empty()) {
         // Place level spq at end of list
-        nonEmptyLevelSPQs.push_back(nextLevelSPQ);
+        nonEmptyLevels.push_back(level);
     }
 
     if (debug >= 2) {
@@ -112,83 +120,33 @@ State *CBFSTree::getNextStateStandard()
 
 State *CBFSTree::getNextStateRandomFromTopK()
 {
-    state_priority_queue *nextLevelSPQ = nonEmptyLevelSPQs.front();
-    nonEmptyLevelSPQs.pop_front();
-
-    vector<State*> bestAtLevel;
-    // Get the <numToSelect> best elements at this level.
-    for (int i = 0; i < numToSelect; ++i) {
-        // If the level's empty, terminate early
-        if (nextLevelSPQ->empty()) {
-            break;
-        }
-
-        // Need to actually remove these elements from the priority queue.
-        // This is going to be relatively inefficient, but if it turns out
-        // to be useful, we can develop a better data structure to use.
-        bestAtLevel.push_back(nextLevelSPQ->top());
-        nextLevelSPQ->pop();
-    }
-
-    // Keep track of how many things are in the bestAtLevel vector
-    int numStates = bestAtLevel.size();
-
-    // Randomly pick an element from the set of best
-    int index = (int)(drand48() * numStates);
-    State* nextState = bestAtLevel[index];
-
-    // Check to see if this element is dominated
-    while (nextState->isDominated()) {
-        // No new states to explore except current dominated one, 
-        // so return it to tree's exploreNextState function for 
-        // proper termination
-        if ((numStates == 0) && (nonEmptyLevelSPQs.empty())) {
-            lastLevelExplored = nextState->getDepth();
-            return nextState;
-        }
-
-        // This only happens if the current level is empty; in this case,
-        // we move to the next level and start over.
-        else if (numStates == 0) {
-            ++tStats->statesPrunedByDomBeforeExploration;
-            return getNextState();
-        }
+    int level = nonEmptyLevels.front();
+    nonEmptyLevels.pop_front();
 
-        // Otherwise, pull another random element from the bestAtLevel vector 
-        // If the level isn't empty, go ahead and keep the bestAtLevel
-        // vector full.  Need to make sure that this happens before the
-        // below call, so that it appears before the element that got
-        // removed.
-        if (!nextLevelSPQ->empty()) {
-            ++tStats->statesPrunedByDomBeforeExploration;
-            bestAtLevel.push_back(nextLevelSPQ->top());
-            nextLevelSPQ->pop();
-            numStates++;
+    State *nextState = takeRandomFromTopK(level);
+    while (nextState->isDominated()) 
+    {
+        if (rankedStates[level]->empty()) 
+        {
+            if (nonEmptyLevels.empty()) 
+            {
+                // No new states to explore except current dominated one, 
+                // so return it to tree's exploreNextState function for 
+                // proper termination
+                lastLevelExplored = nextState->getDepth();
+                return nextState;
+            }
+            level = nonEmptyLevels.front();
+            nonEmptyLevels.pop_front();
         }
-
-        // This is why we don't use bestAtLevel.size(); remove just shunts
-        // the element to the back of the vector instead of actually
-        // deleting it, which is fine for what we need to do.
-        remove(bestAtLevel.begin(), bestAtLevel.end(), nextState);
-        numStates--;
-
-        // Try again
-        index = (int) (drand48() * numStates);
-        nextState = bestAtLevel[index];
-    }
-
-    // Remove the selected element from the best vector, and push everything
-    // else back onto the priority queue.
-    remove(bestAtLevel.begin(), bestAtLevel.end(), nextState);
-    numStates--;
-
-    for (int i = 0; i < numStates; ++i) {
-        nextLevelSPQ->push(bestAtLevel[i]); 
+        skipState(nextState);
+        ++tStats->statesPrunedByDomBeforeExploration;
+        nextState = takeRandomFromTopK(level);
     }
 
-    if (!(*nextLevelSPQ).empty()) {
-        // Place level spq at end of list
-        nonEmptyLevelSPQs.push_back(nextLevelSPQ);
+    if (!rankedStates[level]->empty()) {
+        // Place level at end of list
+        nonEmptyLevels.push_back(level);
     }
 
     if (debug >= 2) {
@@ -198,102 +156,203 @@ State *CBFSTree::getNextStateRandomFromTopK()
     return nextState;
 }
 
-State *CBFSTree::getNextStateFromCurLevel()
+// Removes a state chosen uniformly at random among the <numToSelect> best 
+// states of a (nonempty) level
+State *CBFSTree::takeRandomFromTopK(int level)
 {
-    state_priority_queue *nextLevelSPQ = nonEmptyLevelSPQs.front();
+    LevelQueue *levelQueue = rankedStates[level];
+    size_t numStates = std::min<size_t>(numToSelect, levelQueue->size());
+    return levelQueue->removeAt((size_t)(randomFraction() * numStates));
+}
 
-    State *nextState = (*nextLevelSPQ).top();
-    (*nextLevelSPQ).pop();
+State *CBFSTree::getNextStateFromCurLevel()
+{
+    if (nextInBatch == levelBatch.size()) takeLevelBatch();
 
-    while (nextState->isDominated()) {
-        if ((*nextLevelSPQ).empty()) {
-            nonEmptyLevelSPQs.pop_front(); // Remove the empty level SPQ
-            numExploredAtCurLevel = 0;
-            if (nonEmptyLevelSPQs.empty()) {
+    State *nextState = levelBatch[nextInBatch++];
+    while (nextState->isDominated()) 
+    {
+        if (nextInBatch == levelBatch.size()) 
+        {
+            if (nonEmptyLevels.empty()) 
+            {
                 // No new states to explore except current dominated one, 
                 // so return it to tree's exploreNextState function for 
                 // proper termination
                 lastLevelExplored = nextState->getDepth();
                 return nextState;
             }
-            nextLevelSPQ = nonEmptyLevelSPQs.front();
+            takeLevelBatch();
         }
-        nextState = (*nextLevelSPQ).top();
-        (*nextLevelSPQ).pop();
+        skipState(nextState);
+        ++tStats->statesPrunedByDomBeforeExploration;
+        nextState = levelBatch[nextInBatch++];
     }
-    ++numExploredAtCurLevel;
+
     if (debug >= 2) {
-        printf("Next state taken from level %d (%d explored at this level)\n", 
-            nextState->getDepth(), numExploredAtCurLevel);
+        printf("Next state taken from level %d (%zu of %zu at this level)\n", 
+            nextState->getDepth(), nextInBatch, levelBatch.size());
     }
-
-    if ((*nextLevelSPQ).empty()) {
-        nonEmptyLevelSPQs.pop_front();
-        numExploredAtCurLevel = 0;
-    } else if (numExploredAtCurLevel >= levelThreshold(nextState->getDepth())) {
-        nonEmptyLevelSPQs.pop_front();
-        numExploredAtCurLevel = 0;
-        nonEmptyLevelSPQs.push_back(nextLevelSPQ);
-    } // else leave level SPQ at front of queue
-
     lastLevelExplored = nextState->getDepth();
     return nextState;
 }
 
+// Takes the best <levelThreshold> states of the level at the front of the 
+// list at once, and moves the level to the back of the list
+void CBFSTree::takeLevelBatch()
+{
+    int level = nonEmptyLevels.front();
+    nonEmptyLevels.pop_front();
+    state_priority_queue *nextLevelSPQ = unexploredStates[level];
+
+    levelBatch.clear();
+    nextInBatch = 0;
+    nextLevelSPQ->pop_best(std::max(levelThreshold(level), 1), levelBatch);
+
+    if (!nextLevelSPQ->empty()) nonEmptyLevels.push_back(level);
+    return;
+}
+
+// A state saved at the level of the batch being explored takes the place of
+// the worst state left in the batch if it is better, so that the batch stays
+// made of the level's best states and no more than <levelThreshold> states 
+// are explored before moving on.  Returns the state to store in the level.
+State *CBFSTree::exchangeWithBatch(State *s)
+{
+    if ((nextInBatch == levelBatch.size()) || 
+        (s->getDepth() != levelBatch.back()->getDepth()) ||
+        !(*levelBatch.back() < *s))
+        return s;
+
+    State *worst = levelBatch.back();
+    levelBatch.pop_back();
+    vector<State *>::iterator pos = levelBatch.begin() + nextInBatch;
+    while ((pos != levelBatch.end()) && !(**pos < *s)) ++pos;
+    levelBatch.insert(pos, s);
+    return worst;
+}
+
 void CBFSTree::saveStateForExploration(State *s)
 {
     int level = s->getDepth();
-    // Check to see if we need to add new level priority queues to store state
-    while (unexploredStates.size() <= level) 
-        unexploredStates.push_back(new state_priority_queue());
+    addLevel(level);
+    if (selectionMethod == K_BEST_AT_LEVEL) s = exchangeWithBatch(s);
 
     // Now insert state into the appropriate priority queue, first checking if 
     // the level was empty before the insert operation
-    bool wasPreviouslyEmpty = (unexploredStates[level])->empty();
-    (unexploredStates[level])->push(s);
+    bool wasPreviouslyEmpty = levelIsEmpty(level);
+    if (selectionMethod == RANDOM_FROM_TOP_K) rankedStates[level]->push(s);
+    else (unexploredStates[level])->push(s);
+    if (wasPreviouslyEmpty) activateLevel(level);
 
-    // Now check to see if we need to add the priority queue to the list of 
-    // nonempty level state priority queues (may preempt all queues in list)
-    if (wasPreviouslyEmpty) 
-	{
-        if (level == lastLevelExplored) 
-		{
-            // We're trying to re-add a state that was just explored, so we 
-            // want this level's SPQ to be placed at the end of the list
-            nonEmptyLevelSPQs.push_back(unexploredStates[level]);
-            return;
-        } // Else we need to do a bit more work
-
-        bool isPrevLevelEmpty = (level > 0) ? (unexploredStates[level - 1])->empty() : true;
-        if ((selectionMethod != K_BEST_AT_LEVEL) || (isPrevLevelEmpty) ||  
-            (numExploredAtCurLevel >= levelThreshold(level - 1))) 
-		{
-            // Simply pre-empt the rest of the stuff in the queue if we're 
-            // using normal selections, or if the previous level is empty or 
-            // if we've explored enough at that level
-            nonEmptyLevelSPQs.push_front(unexploredStates[level]);
-        } 
-		else 
-		{
-            // Otherwise previous level is still sitting at the front of the 
-            // non-empty level SPQ's, so we need to do some reordering.
-            state_priority_queue *prevLevelSPQ = nonEmptyLevelSPQs.front();
-            nonEmptyLevelSPQs.pop_front();
-            nonEmptyLevelSPQs.push_front(unexploredStates[level]);
-            nonEmptyLevelSPQs.push_front(prevLevelSPQ);
+    return;
+}
+
+void CBFSTree::saveStatesForExploration(vector<State*>& states)
+{
+    // Children usually all sit on the same level, so insert each run of 
+    // same-level states into its priority queue in a single operation
+    auto runStart = states.begin();
+    while (runStart != states.end())
+    {
+        int level = (*runStart)->getDepth();
+        auto runEnd = runStart + 1;
+        while ((runEnd != states.end()) && ((*runEnd)->getDepth() == level))
+            ++runEnd;
+        if (selectionMethod == K_BEST_AT_LEVEL)
+        {
+            for (auto it = runStart; it != runEnd; ++it) 
+                *it = exchangeWithBatch(*it);
         }
+
+        addLevel(level);
+        bool wasPreviouslyEmpty = levelIsEmpty(level);
+        if (selectionMethod == RANDOM_FROM_TOP_K) 
+            rankedStates[level]->push(runStart, runEnd);
+        else (unexploredStates[level])->push(runStart, runEnd);
+        if (wasPreviouslyEmpty) activateLevel(level);
+
+        runStart = runEnd;
     }
+    return;
+}
 
+State *CBFSTree::peekBestBoundState()
+{
+    // The best state overall is the best of the top states at each level 
+    // and of the states taken by K_BEST_AT_LEVEL but not explored yet
+    State *best = NULL;
+    for (size_t i = nextInBatch; i < levelBatch.size(); ++i)
+    {
+        State *s = levelBatch[i];
+        if ((best == NULL) ||
+            ((problemType == MIN) && (s->getLB() < best->getLB())) ||
+            ((problemType == MAX) && (s->getUB() > best->getUB())))
+            best = s;
+    }
+    for (auto it = nonEmptyLevels.begin(); it != nonEmptyLevels.end(); ++it) 
+    {
+        if (levelIsEmpty(*it)) continue;
+        State *s = topAtLevel(*it);
+        if ((best == NULL) ||
+            ((problemType == MIN) && (s->getLB() < best->getLB())) ||
+            ((problemType == MAX) && (s->getUB() > best->getUB())))
+            best = s;
+    }
+    return best;
+}
+
+void CBFSTree::addLevel(int level)
+{
+    // Check to see if we need to add new level priority queues to store state
+    // (RANDOM_FROM_TOP_K keeps its states in rank-addressable queues instead)
+    if (selectionMethod == RANDOM_FROM_TOP_K)
+    {
+        while (rankedStates.size() <= level) 
+            rankedStates.push_back(new LevelQueue());
+    }
+    else
+    {
+        while (unexploredStates.size() <= level) 
+            unexploredStates.push_back(new state_priority_queue());
+    }
+    return;
+}
+
+void CBFSTree::activateLevel(int level)
+{
+    // Add a level's priority queue that just became nonempty to the list of 
+    // nonempty level state priority queues (may preempt all queues in list)
+    if (level == lastLevelExplored) 
+    {
+        // We're trying to re-add a state that was just explored, so we 
+        // want this level's SPQ to be placed at the end of the list
+        nonEmptyLevels.push_back(level);
+        return;
+    }
+
+    // Simply pre-empt the rest of the stuff in the queue (K_BEST_AT_LEVEL 
+    // has already taken the states it still has to explore at its current
+    // level off the list)
+    nonEmptyLevels.push_front(level);
     return;
 }
 
 /*****************************************************************************/
 /* CBFSTree miscellaneous function definitions                               */
 /*****************************************************************************/
+int logLevelThreshold(int level, int k)
+{
+    return (level > 1) ? (int)ceil(log(level) / log(2)) + 1 : 1;
+}
+
 void CBFSTree::printLevelSizes()
 {
-    for (int i = 0; i < unexploredStates.size(); ++i) {
-        printf("%d: %d states\n", i, unexploredStates[i]->size());
+    int numLevels = (selectionMethod == RANDOM_FROM_TOP_K) ? 
+        rankedStates.size() : unexploredStates.size();
+    for (int i = 0; i < numLevels; ++i) {
+        printf("%d: %lld states (%zu bytes)\n", i, getNumLiveStatesAtLevel(i), 
+               getLiveBytesAtLevel(i));
     }
     return;
 }
@@ -16,11 +16,18 @@ using std::vector;
 #include <list>
 using std::list;
 
+#include "levelqueue.h"
+
 // Global constants for CBFSTree
 const int STANDARD = 0;
 const int RANDOM_FROM_TOP_K = 1;
 const int K_BEST_AT_LEVEL = 2;
 
+// Number of states K_BEST_AT_LEVEL explores at a level (given k) before 
+// moving on to the next level
+typedef int (*level_threshold_func)(int level, int k);
+int logLevelThreshold(int level, int k);
+
 // Forward Declarations
 class State;
 class BTree;
@@ -43,10 +50,16 @@ class CBFSTree : public BTree
     CBFSTree(int probType, bool isIntProb, int selMethod = STANDARD, int k = 1);
     virtual ~CBFSTree();
 
+    // Replaces the constant per-level count <k> of K_BEST_AT_LEVEL (NULL 
+    // restores it); e.g. logLevelThreshold explores more states at deeper 
+    // levels
+    void setLevelThreshold(level_threshold_func f) { thresholdFunc = f; }
+
   protected:
     // Variables
     vector<state_priority_queue *> unexploredStates;
-    list<state_priority_queue *> nonEmptyLevelSPQs;
+    vector<LevelQueue *> rankedStates; // Used instead by RANDOM_FROM_TOP_K
+    list<int> nonEmptyLevels;
 
     // For tracking CBFS search statistics 
     CBFSTreeStats *cbfsStats;
@@ -55,11 +68,20 @@ class CBFSTree : public BTree
     virtual bool isEmpty() const;
     virtual State *getNextState();
     virtual void saveStateForExploration(State *s);
+    virtual void saveStatesForExploration(vector<State*>& states);
+    virtual State *peekBestBoundState();
 
     // Class functions specific to CBFSTree
     State *getNextStateStandard();
     State *getNextStateRandomFromTopK();
+    State *takeRandomFromTopK(int level);
     State *getNextStateFromCurLevel();
+    void takeLevelBatch();
+    State *exchangeWithBatch(State *s);
+    void addLevel(int level);
+    void activateLevel(int level);
+    bool levelIsEmpty(int level) const;
+    State *topAtLevel(int level) const;
 
     void printLevelSizes();
     int levelThreshold(int level);
@@ -67,9 +89,15 @@ class CBFSTree : public BTree
     // Miscellaneous variables
     int selectionMethod;
 	int numToSelect;
-    int numExploredAtCurLevel;
+    level_threshold_func thresholdFunc;
     int lastLevelExplored;
 
+    // K_BEST_AT_LEVEL takes the states it explores at a level all at once;
+    // those not explored yet are still part of the tree, and better states
+    // saved at that level meanwhile replace the worst of them
+    vector<State *> levelBatch;
+    size_t nextInBatch;
+
   private:
     // Nothing
 };
@@ -79,13 +107,24 @@ class CBFSTree : public BTree
 /*****************************************************************************/
 inline bool CBFSTree::isEmpty() const
 {
-    return nonEmptyLevelSPQs.empty();
+    return nonEmptyLevels.empty() && (nextInBatch == levelBatch.size());
+}
+
+inline bool CBFSTree::levelIsEmpty(int level) const
+{
+    if (selectionMethod == RANDOM_FROM_TOP_K) return rankedStates[level]->empty();
+    return unexploredStates[level]->empty();
+}
+
+inline State *CBFSTree::topAtLevel(int level) const
+{
+    if (selectionMethod == RANDOM_FROM_TOP_K) return rankedStates[level]->top();
+    return unexploredStates[level]->top();
 }
 
 inline int CBFSTree::levelThreshold(int level) 
 {
-    return numToSelect;
-    //return ceil(log(level) / log(2)) + 1;
+    return thresholdFunc ? thresholdFunc(level, numToSelect) : numToSelect;
 }
 
 #endif // CBFSTREE_H
@@ -0,0 +1,78 @@
+/*****************************************************************************/
+/* File: counter.h                                                           */
+/* Description:                                                              */
+/*   Contains the design details for a 64-bit statistics counter that is     */
+/*   split into per-thread, cache-line-padded shards.                        */
+/*****************************************************************************/
+#ifndef COUNTER_H
+#define COUNTER_H
+
+// Required include's
+#include <atomic>
+
+// Global constants
+const int NUM_COUNTER_SHARDS = 8;
+const int CACHE_LINE_SIZE = 64;
+
+// A 64-bit event counter.  Every thread adds to its own shard (threads are
+// given shards round-robin), and each shard sits on its own cache line, so
+// counting from several threads neither races nor bounces a shared line
+// between cores.  Reading the counter adds up the shards; it is exact once
+// the counting threads are done and a close estimate while they run.
+class ShardedCounter
+{
+  public:
+    ShardedCounter(long long v = 0) { set(v); }
+    ShardedCounter(const ShardedCounter& other) { set(other.value()); }
+
+    ShardedCounter& operator=(long long v) { set(v); return *this; }
+    ShardedCounter& operator=(const ShardedCounter& other) { set(other.value()); return *this; }
+    ShardedCounter& operator+=(long long d) { mine().fetch_add(d, std::memory_order_relaxed); return *this; }
+    ShardedCounter& operator-=(long long d) { return (*this += -d); }
+    ShardedCounter& operator++() { return (*this += 1); }
+    ShardedCounter& operator--() { return (*this += -1); }
+
+    long long value() const;
+    operator long long() const { return value(); }
+
+  private:
+    // Padded rather than aligned (heap allocations are only 16-byte 
+    // aligned), which still keeps any two shards' counts on separate lines
+    struct Shard
+    {
+        std::atomic<long long> count;
+        char padding[CACHE_LINE_SIZE - sizeof(std::atomic<long long>)];
+    };
+    Shard shards[NUM_COUNTER_SHARDS];
+
+    void set(long long v);
+    std::atomic<long long>& mine() { return shards[threadShard()].count; }
+    static int threadShard();
+};
+
+/*****************************************************************************/
+/* ShardedCounter inline function definitions                                */
+/*****************************************************************************/
+inline long long ShardedCounter::value() const
+{
+    long long total = 0;
+    for (int i = 0; i < NUM_COUNTER_SHARDS; ++i)
+        total += shards[i].count.load(std::memory_order_relaxed);
+    return total;
+}
+
+inline void ShardedCounter::set(long long v)
+{
+    shards[0].count.store(v, std::memory_order_relaxed);
+    for (int i = 1; i < NUM_COUNTER_SHARDS; ++i)
+        shards[i].count.store(0, std::memory_order_relaxed);
+}
+
+inline int ShardedCounter::threadShard()
+{
+    static std::atomic<int> nextShard(0);
+    static thread_local int shard = nextShard++ % NUM_COUNTER_SHARDS;
+    return shard;
+}
+
+#endif // COUNTER_H
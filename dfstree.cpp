@@ -34,7 +34,7 @@ DFSTree::~DFSTree()
 		while (!isEmpty()) 
 		{
 		   State *ns = getNextState();
-		   delete ns;
+		   discardState(ns);
 		}
 	}
 }
@@ -47,6 +47,7 @@ State *DFSTree::getNextState()
     State* nextState = unexploredStates.top();
     unexploredStates.pop();
     while ((nextState->isDominated()) && (!unexploredStates.empty())) {
+        skipState(nextState);
         nextState = unexploredStates.top();
         unexploredStates.pop();
         ++tStats->statesPrunedByDomBeforeExploration;
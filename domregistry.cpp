@@ -0,0 +1,276 @@
+/*****************************************************************************/
+/* File: domregistry.cpp                                                     */
+/* Description:                                                              */
+/*   Contains the implementation details for the dominance class registry.   */
+/*****************************************************************************/
+#include "state.h"
+#include "domregistry.h"
+
+/*****************************************************************************/
+/* DominanceRegistry constructor and destructor                              */
+/*****************************************************************************/
+DominanceRegistry::DominanceRegistry(int numShards) :
+    maxStatesPerClass(0),
+    maxStatesTotal(0),
+    evictionPolicy(EVICT_OLDEST),
+    problemType(0),
+    totalStates(0),
+    totalExplored(0),
+    bytesHeld(0),
+    clock(0),
+    sweepShard(0),
+    sweepSlot(0)
+{
+    size_t n = 1;
+    while (n < numShards) n *= 2;
+    shardMask = n - 1;
+    for (size_t i = 0; i < n; ++i)
+        shards.push_back(new Shard());
+}
+
+DominanceRegistry::~DominanceRegistry()
+{
+    // States are owned by the tree; only the shards themselves are freed here
+    for (size_t i = 0; i < shards.size(); ++i)
+        delete shards[i];
+}
+
+/*****************************************************************************/
+/* DominanceRegistry functions                                               */
+/*****************************************************************************/
+int DominanceRegistry::insert(State *s)
+{
+    int classID = s->getDomClassID();
+    size_t hash = hashID(classID);
+    int numEvicted = 0;
+    {
+        Shard &shard = shardFor(hash);
+        std::lock_guard<std::mutex> guard(shard.lock);
+
+        // Keep the load factor of the shard below 3/4
+        if (4 * (shard.numUsed + 1) > 3 * shard.slots.size()) grow(shard);
+
+        Slot *slot = findSlot(shard, classID, hash);
+        if (!slot->used)
+        {
+            slot->used = true;
+            slot->classID = classID;
+            ++shard.numUsed;
+        }
+        slot->states.push_back(s, tick());
+        ++totalStates;
+
+        if ((maxStatesPerClass > 0) && (slot->states.size() > maxStatesPerClass))
+            numEvicted += evictFrom(slot->states);
+    }
+
+    if ((maxStatesTotal > 0) && (totalStates > maxStatesTotal) && (totalExplored > 0))
+        numEvicted += evictGlobally();
+    return numEvicted;
+}
+
+bool DominanceRegistry::markExplored(State *s, DomSignature *sig)
+{
+    size_t stateBytes = s->memoryUsage();
+    bytesHeld += stateBytes;
+
+    int classID = s->getDomClassID();
+    size_t hash = hashID(classID);
+    Shard &shard = shardFor(hash);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    Slot *slot = findSlot(shard, classID, hash);
+    if (!slot || !slot->used) return false;
+
+    // Counted even without limits, which may be set later in the search
+    DomClass &domClass = slot->states;
+    ++domClass.numExplored;
+    ++totalExplored;
+    if (sig == NULL) return false;
+
+    // Swap the state for its signature (recently stored states are more 
+    // likely to be explored next, so search from the back)
+    for (size_t i = domClass.size(); i-- > 0; )
+    {
+        DomEntry &e = domClass.entry(i);
+        if (e.state == s)
+        {
+            e.state = NULL;
+            e.signature = sig;
+            bytesHeld -= stateBytes;
+            bytesHeld += sig->memoryUsage();
+            return true;
+        }
+    }
+    return false;
+}
+
+void DominanceRegistry::setLimits(int maxPerClass, int maxTotal, int policy, int probType)
+{
+    maxStatesPerClass = maxPerClass;
+    maxStatesTotal = maxTotal;
+    evictionPolicy = policy;
+    problemType = probType;
+}
+
+void DominanceRegistry::deleteAllStates()
+{
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        Shard &shard = *shards[i];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        for (size_t j = 0; j < shard.slots.size(); ++j)
+        {
+            DomClass &domClass = shard.slots[j].states;
+            for (size_t k = 0; k < domClass.size(); ++k)
+            {
+                delete domClass[k];
+                delete domClass.signature(k);
+            }
+        }
+        shard.slots.clear();
+        shard.numUsed = 0;
+    }
+    totalStates = 0;
+    totalExplored = 0;
+    bytesHeld = 0;
+    return;
+}
+
+size_t DominanceRegistry::numClasses() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        std::lock_guard<std::mutex> guard(shards[i]->lock);
+        total += shards[i]->numUsed;
+    }
+    return total;
+}
+
+// Returns the slot holding classID, or the empty slot where it would go (NULL 
+// if the shard has no slots yet).  The shard must be locked by the caller.
+DominanceRegistry::Slot *DominanceRegistry::findSlot(Shard &shard, int classID, size_t hash)
+{
+    if (shard.slots.empty()) return NULL;
+    size_t mask = shard.slots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        Slot &slot = shard.slots[i];
+        if (!slot.used || slot.classID == classID) return &slot;
+    }
+}
+
+// Drops one explored state from the class according to the eviction policy. 
+// Returns false if every state in the class is still waiting in the tree.  
+// The class's shard must be locked by the caller.
+bool DominanceRegistry::evictFrom(DomClass &domClass)
+{
+    if (domClass.numExplored == 0) return false;
+
+    int victim = -1;
+    size_t numSeen = 0;
+    for (size_t i = 0; (i < domClass.size()) && (numSeen < domClass.numExplored); ++i)
+    {
+        const DomEntry &e = domClass.entry(i);
+        if (!e.signature && !e.state->wasProcessed()) continue;
+        ++numSeen;
+        if (victim < 0) 
+        {
+            victim = i;
+            if (evictionPolicy == EVICT_OLDEST) break;
+            continue;
+        }
+
+        const DomEntry &v = domClass.entry(victim);
+        bool better;
+        if (evictionPolicy == EVICT_WORST_BOUND)
+        {
+            if (problemType == 0 /* MIN */) 
+                better = (e.state ? e.state->getLB() : e.signature->getLB()) > 
+                         (v.state ? v.state->getLB() : v.signature->getLB());
+            else
+                better = (e.state ? e.state->getUB() : e.signature->getUB()) < 
+                         (v.state ? v.state->getUB() : v.signature->getUB());
+        }
+        else // evictionPolicy == EVICT_LEAST_RECENTLY_DOMINATING
+            better = (e.lastUse < v.lastUse);
+        if (better) victim = i;
+    }
+    if (victim < 0) return false;
+
+    const DomEntry &v = domClass.entry(victim);
+    bytesHeld -= v.state ? v.state->memoryUsage() : v.signature->memoryUsage();
+    delete domClass[victim];
+    delete domClass.signature(victim);
+    domClass.erase(victim);
+    ++domClass.numEvicted;
+    --domClass.numExplored;
+    --totalStates;
+    --totalExplored;
+    return true;
+}
+
+// Visits the classes round-robin until one of them can give up a state. 
+// Returns the number of states evicted.
+int DominanceRegistry::evictGlobally()
+{
+    // Only one thread needs to sweep at a time
+    std::unique_lock<std::mutex> sweep(sweepLock, std::try_to_lock);
+    if (!sweep.owns_lock()) return 0;
+
+    int numEvicted = 0;
+    size_t numVisited = 0;
+    while ((totalStates > maxStatesTotal) && (totalExplored > 0) && 
+           (numVisited < 2 * shards.size()))
+    {
+        Shard &shard = *shards[sweepShard];
+        bool evicted = false;
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            for (; sweepSlot < shard.slots.size(); ++sweepSlot)
+            {
+                Slot &slot = shard.slots[sweepSlot];
+                if (slot.used && evictFrom(slot.states)) 
+                {
+                    evicted = true;
+                    ++sweepSlot;
+                    break;
+                }
+            }
+        }
+
+        if (evicted) 
+        {
+            ++numEvicted;
+            numVisited = 0;
+        }
+        else
+        {
+            // Nothing left to evict in this shard; move on to the next one
+            sweepShard = (sweepShard + 1) % shards.size();
+            sweepSlot = 0;
+            ++numVisited;
+        }
+    }
+    return numEvicted;
+}
+
+void DominanceRegistry::grow(Shard &shard)
+{
+    vector<Slot> oldSlots;
+    oldSlots.swap(shard.slots);
+
+    Slot empty;
+    empty.classID = 0;
+    empty.used = false;
+    shard.slots.assign(oldSlots.empty() ? 8 : 2 * oldSlots.size(), empty);
+
+    for (size_t i = 0; i < oldSlots.size(); ++i)
+    {
+        if (!oldSlots[i].used) continue;
+        Slot *slot = findSlot(shard, oldSlots[i].classID, hashID(oldSlots[i].classID));
+        std::swap(*slot, oldSlots[i]);
+    }
+    return;
+}
+
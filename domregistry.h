@@ -0,0 +1,203 @@
+/*****************************************************************************/
+/* File: domregistry.h                                                       */
+/* Description:                                                              */
+/*   Contains the design details for the dominance class registry, which     */
+/*   maps dominance class IDs to the states stored in each class.            */
+/*****************************************************************************/
+#ifndef DOMREGISTRY_H
+#define DOMREGISTRY_H
+
+// Required include's
+#include <vector>
+using std::vector;
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// Forward Declarations
+class State;
+class DomSignature;
+
+// Number of states a dominance class holds without any heap allocation
+const int DOMCLASS_INLINE_SIZE = 4;
+
+// Policies for choosing which state to drop when the dominance memory is full.
+// Only states that have already been explored (or pruned when selected) are 
+// ever dropped; states still waiting in the tree are kept.
+const int EVICT_OLDEST = 0;                  // Earliest stored state
+const int EVICT_WORST_BOUND = 1;             // Highest LB (MIN) / lowest UB (MAX)
+const int EVICT_LEAST_RECENTLY_DOMINATING = 2; // Longest since it dominated a state
+
+// A stored state (or, once it has been explored and released, its dominance
+// signature) together with the last time it was stored or dominated another 
+// state
+struct DomEntry
+{
+    State *state;
+    DomSignature *signature;
+    unsigned long long lastUse;
+};
+
+// A dominance class is a list of states that may dominate each other.  Most 
+// classes are small, so the first few states are kept inline and only larger 
+// classes spill over into a heap-allocated vector.  States keep their 
+// insertion order.
+class DomClass
+{
+  public:
+    DomClass() : count(0), numEvicted(0), numExplored(0), inlineEntries() {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    // The i-th state, or NULL if only its signature is kept
+    State *operator[](size_t i) const { return entry(i).state; }
+    DomSignature *signature(size_t i) const { return entry(i).signature; }
+
+    void push_back(State *s, unsigned long long stamp = 0)
+    {
+        DomEntry e = { s, NULL, stamp };
+        if (count < DOMCLASS_INLINE_SIZE) inlineEntries[count] = e;
+        else overflow.push_back(e);
+        ++count;
+    }
+
+    // Removes the i-th state, keeping the others in order
+    void erase(size_t i)
+    {
+        for (; i + 1 < count; ++i) entry(i) = entry(i + 1);
+        if (count > DOMCLASS_INLINE_SIZE) overflow.pop_back();
+        --count;
+    }
+
+    void touch(size_t i, unsigned long long stamp) { entry(i).lastUse = stamp; }
+    unsigned long long lastUse(size_t i) const { return entry(i).lastUse; }
+
+    // Number of states dropped from this class by the memory limits
+    size_t evictions() const { return numEvicted; }
+
+    void clear() { count = 0; overflow.clear(); }
+
+  private:
+    friend class DominanceRegistry;
+
+    size_t count;
+    size_t numEvicted;
+    size_t numExplored; // States that have left the tree (eviction candidates)
+    DomEntry inlineEntries[DOMCLASS_INLINE_SIZE];
+    vector<DomEntry> overflow;
+
+    DomEntry &entry(size_t i) 
+    { 
+        return (i < DOMCLASS_INLINE_SIZE) ? inlineEntries[i] : overflow[i - DOMCLASS_INLINE_SIZE];
+    }
+    const DomEntry &entry(size_t i) const 
+    { 
+        return (i < DOMCLASS_INLINE_SIZE) ? inlineEntries[i] : overflow[i - DOMCLASS_INLINE_SIZE];
+    }
+};
+
+// The registry is split into shards by dominance class ID, and each shard is 
+// an open-addressed hash table (linear probing) holding its classes by value.
+// Every shard has its own lock, so threads working on classes in different 
+// shards never wait for each other.
+class DominanceRegistry
+{
+  public:
+    DominanceRegistry(int numShards = 16);
+    ~DominanceRegistry();
+
+    // Calls f(domClass) with the class's shard locked; does nothing if the 
+    // class has no states yet
+    template <typename Func>
+    void withClass(int classID, Func f);
+
+    // Adds a state to its dominance class, creating the class if needed. If 
+    // this takes the class or the registry over its limit, explored states 
+    // are dropped (and deleted) according to the eviction policy.  Returns 
+    // the number of states evicted.
+    int insert(State *s);
+
+    // Records that a stored state has left the tree, making it a candidate 
+    // for eviction.  If sig is given, it
+    // takes the place of the state in its class; returns true if so, in which
+    // case the caller may delete the state.
+    bool markExplored(State *s, DomSignature *sig = NULL);
+
+    // Caps the number of states per class and in total (0 means no limit)
+    void setLimits(int maxPerClass, int maxTotal, int policy, int probType);
+
+    // Returns a new timestamp, used to record when a state last dominated
+    unsigned long long tick() { return ++clock; }
+
+    // Deletes every state held in the registry and removes all classes
+    void deleteAllStates();
+
+    size_t numClasses() const;
+    size_t numStates() const { return totalStates; }
+
+    // Bytes (State/DomSignature::memoryUsage) held by explored states and 
+    // signatures; states still waiting in the tree are counted by the tree
+    size_t numBytesHeld() const { return bytesHeld; }
+
+  private:
+    struct Slot
+    {
+        int classID;
+        bool used;
+        DomClass states;
+    };
+
+    struct Shard
+    {
+        Shard() : numUsed(0) {}
+        mutable std::mutex lock;
+        vector<Slot> slots; // Size is zero or a power of two
+        size_t numUsed;
+    };
+
+    vector<Shard *> shards;
+    size_t shardMask;
+
+    // Memory limits
+    int maxStatesPerClass;
+    int maxStatesTotal;
+    int evictionPolicy;
+    int problemType;
+    std::atomic<size_t> totalStates;
+    std::atomic<size_t> totalExplored;
+    std::atomic<size_t> bytesHeld;
+    std::atomic<unsigned long long> clock;
+
+    // Position of the round-robin sweep used to enforce the global limit
+    std::mutex sweepLock;
+    size_t sweepShard, sweepSlot;
+
+    static size_t hashID(int classID);
+    Shard &shardFor(size_t hash) { return *shards[(hash >> 32) & shardMask]; }
+    static Slot *findSlot(Shard &shard, int classID, size_t hash);
+    static void grow(Shard &shard);
+    bool evictFrom(DomClass &domClass);
+    int evictGlobally();
+};
+
+/*****************************************************************************/
+/* DominanceRegistry inline and template function definitions                */
+/*****************************************************************************/
+inline size_t DominanceRegistry::hashID(int classID)
+{
+    // Fibonacci hashing spreads consecutive IDs over shards and slots
+    return (size_t)((unsigned long long)(unsigned int)classID * 0x9E3779B97F4A7C15ULL);
+}
+
+template <typename Func>
+void DominanceRegistry::withClass(int classID, Func f)
+{
+    size_t hash = hashID(classID);
+    Shard &shard = shardFor(hash);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    Slot *slot = findSlot(shard, classID, hash);
+    if (slot && slot->used && !slot->states.empty()) f(slot->states);
+}
+
+#endif // DOMREGISTRY_H
+
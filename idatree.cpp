@@ -0,0 +1,119 @@
+/*****************************************************************************/
+/* File: idatree.cpp                                                         */
+/* Description:                                                              */
+/*   Contains the implementation details for an iterative bound deepening    */
+/*   (IDA*) branching tree class.                                            */
+/*****************************************************************************/
+#include "state.h"
+#include "btree.h"
+#include "iterativetree.h"
+#include "idatree.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/*****************************************************************************/
+/* IDATree constructor, destructor, and initialization functions             */
+/*****************************************************************************/
+IDATree::IDATree(int probType, bool isIntProb, double minStep) :
+	IterativeTree(probType, isIntProb),
+	threshold(0.0),
+	thresholdStep(minStep)
+{
+	name = "*** IDA ***";
+    idaStats = new IDATreeStats();
+    tStats = idaStats; // Make tStats pointer point to idaStats
+    iterStats = idaStats;
+}
+
+IDATree::~IDATree()
+{
+    // Calls BTree destructor by default
+    while (!unexploredStates.empty())
+    {
+        discardState(unexploredStates.top());
+        unexploredStates.pop();
+    }
+}
+
+/*****************************************************************************/
+/* IDATree search functions                                                  */
+/*****************************************************************************/
+State *IDATree::getNextState()
+{
+    if (unexploredStates.empty()) startNextIteration();
+
+    State* nextState = unexploredStates.top();
+    unexploredStates.pop();
+    return nextState;
+}
+
+// The threshold of the first iteration is the root's bound
+void IDATree::saveStateForExploration(State *s)
+{
+    if (startsNewSearch(s))
+    {
+        threshold = (problemType == MIN) ? s->getLB() : s->getUB();
+        idaStats->finalThreshold = threshold;
+    }
+    if (exceedsThreshold(s))
+    {
+        cutOff(s);
+        return;
+    }
+    unexploredStates.push(s);
+    return;
+}
+
+void IDATree::startNextIteration()
+{
+    // Everything within the old threshold has been explored, so no solution
+    // is better than the best bound that was cut off
+    double tol = pruneTolerance();
+    if (problemType == MIN)
+    {
+        globalLowerBound = std::max(globalLowerBound, std::min(bestCutBound, globalUpperBound - tol));
+        threshold = std::max(bestCutBound, threshold + thresholdStep);
+    }
+    else // problemType == MAX
+    {
+        globalUpperBound = std::min(globalUpperBound, std::max(bestCutBound, globalLowerBound + tol));
+        threshold = std::min(bestCutBound, threshold - thresholdStep);
+    }
+    unexploredStates.push(restartFromRoot());
+    idaStats->finalThreshold = threshold;
+    if (debug >= 2)
+        printf("Starting iteration %lld with threshold %g\n", idaStats->iterations, threshold);
+    return;
+}
+
+bool IDATree::exceedsThreshold(State *s) const
+{
+    if (problemType == MIN) return s->getLB() > threshold + eps;
+    else /* problemType == MAX */ return s->getUB() < threshold - eps;
+}
+
+/*****************************************************************************/
+/* IDATreeStats function definitions                                         */
+/*****************************************************************************/
+IDATreeStats::IDATreeStats() :
+    finalThreshold(0.0)
+{
+    // Calls IterativeTreeStats constructor by default
+}
+
+IDATreeStats::~IDATreeStats()
+{
+    // Calls IterativeTreeStats destructor by default
+    // Clean-up
+}
+
+void IDATreeStats::print() const
+{
+    TreeStats::print();
+    // Put extra IDATree printing here
+    printf("Printing IDA Tree Stats\n");
+    printf("Iterations: %lld (final threshold %g)\n", iterations, finalThreshold);
+    printf("States cut off by the threshold: %lld\n", statesCutOff);
+    return;
+}
@@ -0,0 +1,75 @@
+/*****************************************************************************/
+/* File: idatree.h                                                           */
+/* Description:                                                              */
+/*   Contains the design details for an iterative bound deepening (IDA*)     */
+/*   branching tree class.                                                   */
+/*****************************************************************************/
+#ifndef IDATREE_H
+#define IDATREE_H
+
+// Required include's
+#include <stack>
+using std::stack;
+
+// Forward Declarations
+class State;
+class IterativeTree;
+struct IterativeTreeStats;
+
+// Used for tracking search statistics
+struct IDATreeStats : public IterativeTreeStats
+{
+    IDATreeStats();
+    virtual ~IDATreeStats();
+    virtual void print() const;
+
+    // Variables for IDATreeStats
+    double finalThreshold;
+};
+
+// Depth-first search that only stores states whose bound is within a
+// threshold (lower bound at most the threshold for MIN problems, upper bound
+// at least the threshold for MAX problems).  States beyond it are deleted,
+// and once everything within it has been explored the search restarts from
+// a copy of the root with the threshold moved to the best bound that was
+// cut off (or by at least <minStep>).  The memory used is that of a DFS,
+// and subtrees that cannot contain good solutions are left until the end.
+// See IterativeTree for the restrictions that come with the restarts.
+class IDATree : public IterativeTree
+{
+  public:
+    // Class functions unique to IDATree
+    IDATree(int probType, bool isIntProb, double minStep = 0.0);
+    virtual ~IDATree();
+
+  protected:
+    // Variables
+    stack<State *> unexploredStates;
+    double threshold;
+    double thresholdStep;
+
+    // For tracking IDA search statistics
+    IDATreeStats *idaStats;
+
+    // Abstract class functions inherited from BTree that will be implemented
+    virtual bool isEmpty() const;
+    virtual State *getNextState();
+    virtual void saveStateForExploration(State *s);
+
+    // Class functions specific to IDATree
+    void startNextIteration();
+    bool exceedsThreshold(State *s) const;
+
+  private:
+    // Nothing
+};
+
+/*****************************************************************************/
+/* IDATree inline function definitions                                       */
+/*****************************************************************************/
+inline bool IDATree::isEmpty() const
+{
+    return unexploredStates.empty() && !nextIterationReady();
+}
+
+#endif // IDATREE_H
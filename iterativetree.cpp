@@ -0,0 +1,151 @@
+/*****************************************************************************/
+/* File: iterativetree.cpp                                                   */
+/* Description:                                                              */
+/*   Contains the implementation details for the base class of branching     */
+/*   trees that search in iterations.                                        */
+/*****************************************************************************/
+#include "state.h"
+#include "btree.h"
+#include "iterativetree.h"
+#include "util.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/*****************************************************************************/
+/* IterativeTree constructor, destructor, and initialization functions       */
+/*****************************************************************************/
+IterativeTree::IterativeTree(int probType, bool isIntProb) :
+	BTree(probType, isIntProb),
+	root(NULL),
+	numCutThisIteration(0),
+	bestCutBound(0.0),
+	cutBoundIndexed(false),
+	iterStats(NULL)
+{
+    // States are deleted once explored; later iterations regenerate them
+    retainStates = false;
+}
+
+IterativeTree::~IterativeTree()
+{
+    // Calls BTree destructor by default
+    delete root;
+}
+
+/*****************************************************************************/
+/* IterativeTree iteration functions                                         */
+/*****************************************************************************/
+// Returns true if s is the root of a new search, after keeping a copy of it
+// for the later iterations.  A state at depth 0 that arrives after the first
+// root is the root of another search, which may only start once the tree is
+// empty.
+bool IterativeTree::startsNewSearch(State *s)
+{
+    if ((root != NULL) && (s->getDepth() > 0)) return false;
+    if (root != NULL)
+    {
+        if (!isEmpty())
+            throw ERROR << name << ": a new root was given before the previous search finished.";
+        delete root;
+        root = NULL;
+    }
+    if (useDom)
+        throw ERROR << name << ": dominance cannot be used; states are revisited by later iterations.";
+    if (transTable)
+        throw ERROR << name << ": a transposition table cannot be used; states are revisited by later iterations.";
+    if (retainStates)
+        throw ERROR << name << ": states cannot be retained.";
+
+    root = s->clone();
+    clearCutBound();
+    numCutThisIteration = 0;
+    iterStats->iterations = 1;
+    return true;
+}
+
+// Returns a new copy of the root (already counted as a live state) for the
+// subclass to store, once it has set the limit of the next iteration
+State *IterativeTree::restartFromRoot()
+{
+    clearCutBound();
+    numCutThisIteration = 0;
+    ++iterStats->iterations;
+
+    State *s = root->clone();
+    addLiveState(s);
+    return s;
+}
+
+// Deletes a state that is beyond the current iteration's limit
+void IterativeTree::cutOff(State *s)
+{
+    double bound = (problemType == MIN) ? s->getLB() : s->getUB();
+    bool isBest = (numCutThisIteration == 0) ||
+        ((problemType == MIN) ? (bound < bestCutBound) : (bound > bestCutBound));
+    ++numCutThisIteration;
+    ++iterStats->statesCutOff;
+    removeLiveState(s);
+    discardState(s);
+
+    // The global bound must still account for the states that were cut off
+    if (isBest)
+    {
+        clearCutBound();
+        bestCutBound = bound;
+        cutBoundIndexed = trackBestBound;
+        if (cutBoundIndexed) frontierBounds.insert(bestCutBound);
+    }
+    return;
+}
+
+// Whether a state that was cut off in this iteration could still improve on
+// the incumbent
+bool IterativeTree::cutStatesCouldImprove() const
+{
+    if (numCutThisIteration == 0) return false;
+    if (problemType == MIN) return bestCutBound < globalUpperBound - pruneTolerance();
+    else /* problemType == MAX */ return bestCutBound > globalLowerBound + pruneTolerance();
+}
+
+bool IterativeTree::nextIterationNeeded() const
+{
+    return cutStatesCouldImprove();
+}
+
+// Whether the next iteration should start now that the current one is out of
+// states.  States still out with the bounding threads belong to the current
+// iteration (they may still be cut off and loosen the next limit), so the 
+// restart waits for them: until then the tree reports itself as empty, which
+// makes explore() wait for the bounding threads.
+bool IterativeTree::nextIterationReady() const
+{
+    return (numPendingBounds == 0) && nextIterationNeeded();
+}
+
+void IterativeTree::clearCutBound()
+{
+    if (cutBoundIndexed)
+    {
+        multiset<double>::iterator it = frontierBounds.find(bestCutBound);
+        if (it != frontierBounds.end()) frontierBounds.erase(it);
+    }
+    cutBoundIndexed = false;
+    return;
+}
+
+/*****************************************************************************/
+/* IterativeTreeStats function definitions                                   */
+/*****************************************************************************/
+IterativeTreeStats::IterativeTreeStats() :
+    iterations(0),
+    statesCutOff(0)
+{
+    // Calls TreeStats constructor by default
+}
+
+IterativeTreeStats::~IterativeTreeStats()
+{
+    // Calls TreeStats destructor by default
+    // Clean-up
+}
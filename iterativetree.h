@@ -0,0 +1,68 @@
+/*****************************************************************************/
+/* File: iterativetree.h                                                     */
+/* Description:                                                              */
+/*   Contains the design details for the base class of branching trees that  */
+/*   search in iterations, each restarting from a copy of the root.          */
+/*****************************************************************************/
+#ifndef ITERATIVETREE_H
+#define ITERATIVETREE_H
+
+// Forward Declarations
+class State;
+class BTree;
+struct TreeStats;
+
+// Used for tracking search statistics
+struct IterativeTreeStats : public TreeStats
+{
+    IterativeTreeStats();
+    virtual ~IterativeTreeStats();
+
+    // Variables for IterativeTreeStats
+    long long iterations;
+    long long statesCutOff; // States deleted for being beyond an iteration's limit
+};
+
+// Base class of IDATree, LDSTree and BeamTree.  Each iteration only keeps the
+// states within some limit and deletes (cuts off) the rest; once it runs out
+// of states, the next one starts from a copy of the root with a looser limit,
+// as long as a state that was cut off could still beat the incumbent.  The
+// best bound cut off in an iteration stands in for those states in the bound
+// index (see setBestBoundTracking), so that the global bound stays valid.
+//
+// Subclasses call startsNewSearch() for every state they are given,
+// restartFromRoot() to begin an iteration and cutOff() for every state
+// beyond the current limit.  States are revisited by later iterations, so
+// they are never retained, and dominance and the transposition table cannot
+// be used.  Once a search has finished, passing a new root to the tree
+// starts a new one.  Subclasses are empty once they are out of states and
+// nextIterationReady() is false.
+class IterativeTree : public BTree
+{
+  public:
+    IterativeTree(int probType, bool isIntProb);
+    virtual ~IterativeTree();
+
+  protected:
+    // Variables
+    State *root; // Copy of the root that every iteration starts from
+    long long numCutThisIteration;
+    double bestCutBound; // Best bound cut off in this iteration, which is
+    bool cutBoundIndexed; // kept in the bound index in place of those states
+
+    // Points to the subclass's statistics
+    IterativeTreeStats *iterStats;
+
+    // Class functions for subclasses
+    bool startsNewSearch(State *s);
+    State *restartFromRoot();
+    void cutOff(State *s);
+    bool cutStatesCouldImprove() const;
+    virtual bool nextIterationNeeded() const;
+    bool nextIterationReady() const;
+
+  private:
+    void clearCutBound();
+};
+
+#endif // ITERATIVETREE_H
@@ -0,0 +1,134 @@
+/*****************************************************************************/
+/* File: ldstree.cpp                                                         */
+/* Description:                                                              */
+/*   Contains the implementation details for a limited discrepancy search    */
+/*   (LDS) branching tree class.                                             */
+/*****************************************************************************/
+#include "state.h"
+#include "btree.h"
+#include "iterativetree.h"
+#include "ldstree.h"
+#include "util.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/*****************************************************************************/
+/* LDSTree constructor, destructor, and initialization functions             */
+/*****************************************************************************/
+LDSTree::LDSTree(int probType, bool isIntProb, int step) :
+	IterativeTree(probType, isIntProb),
+	lastState(NULL),
+	lastDiscrepancies(0),
+	discrepancyLimit(0),
+	discrepancyStep(std::max(step, 1))
+{
+	name = "*** LDS ***";
+    ldsStats = new LDSTreeStats();
+    tStats = ldsStats; // Make tStats pointer point to ldsStats
+    iterStats = ldsStats;
+}
+
+LDSTree::~LDSTree()
+{
+    // Calls BTree destructor by default
+    for (size_t i = 0; i < unexploredStates.size(); ++i)
+        discardState(unexploredStates[i].first);
+    for (size_t i = 0; i < newChildren.size(); ++i)
+        discardState(newChildren[i]);
+}
+
+/*****************************************************************************/
+/* LDSTree search functions                                                  */
+/*****************************************************************************/
+State *LDSTree::getNextState()
+{
+    if (unexploredStates.empty()) startNextIteration();
+
+    lastState = unexploredStates.back().first;
+    lastDiscrepancies = unexploredStates.back().second;
+    unexploredStates.pop_back();
+    return lastState;
+}
+
+void LDSTree::saveStateForExploration(State *s)
+{
+    if (s == lastState) // Put back without being explored
+        unexploredStates.push_back(pair<State *, int>(s, lastDiscrepancies));
+    else if (startsNewSearch(s))
+    {
+        if (boundPool)
+            throw ERROR << "LDSTree cannot use bounding threads.";
+        discrepancyLimit = 0;
+        ldsStats->finalDiscrepancyLimit = 0;
+        unexploredStates.push_back(pair<State *, int>(s, 0));
+    }
+    else
+        newChildren.push_back(s);
+    return;
+}
+
+void LDSTree::exploreNextState()
+{
+    try
+    {
+        BTree::exploreNextState();
+    }
+    catch (AbortException& e)
+    {
+        // The children of an interrupted branch() cannot be told apart, so
+        // they are cut off; the next iteration regenerates them
+        for (size_t i = 0; i < newChildren.size(); ++i) cutOff(newChildren[i]);
+        newChildren.clear();
+        lastState = NULL;
+        throw;
+    }
+
+    // Only now is it known which child was created last
+    for (size_t i = 0; i < newChildren.size(); ++i)
+    {
+        int d = lastDiscrepancies + ((i + 1 < newChildren.size()) ? 1 : 0);
+        if (d > discrepancyLimit) cutOff(newChildren[i]);
+        else unexploredStates.push_back(pair<State *, int>(newChildren[i], d));
+    }
+    newChildren.clear();
+    lastState = NULL;
+    return;
+}
+
+void LDSTree::startNextIteration()
+{
+    discrepancyLimit += discrepancyStep;
+    unexploredStates.push_back(pair<State *, int>(restartFromRoot(), 0));
+    ldsStats->finalDiscrepancyLimit = discrepancyLimit;
+    if (debug >= 2)
+        printf("Starting iteration %lld allowing %d discrepancies\n",
+               ldsStats->iterations, discrepancyLimit);
+    return;
+}
+
+/*****************************************************************************/
+/* LDSTreeStats function definitions                                         */
+/*****************************************************************************/
+LDSTreeStats::LDSTreeStats() :
+    finalDiscrepancyLimit(0)
+{
+    // Calls IterativeTreeStats constructor by default
+}
+
+LDSTreeStats::~LDSTreeStats()
+{
+    // Calls IterativeTreeStats destructor by default
+    // Clean-up
+}
+
+void LDSTreeStats::print() const
+{
+    TreeStats::print();
+    // Put extra LDSTree printing here
+    printf("Printing LDS Tree Stats\n");
+    printf("Iterations: %lld (final limit of %d discrepancies)\n",
+           iterations, finalDiscrepancyLimit);
+    printf("States cut off by the discrepancy limit: %lld\n", statesCutOff);
+    return;
+}
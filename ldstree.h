@@ -0,0 +1,84 @@
+/*****************************************************************************/
+/* File: ldstree.h                                                           */
+/* Description:                                                              */
+/*   Contains the design details for a limited discrepancy search (LDS)      */
+/*   branching tree class.                                                   */
+/*****************************************************************************/
+#ifndef LDSTREE_H
+#define LDSTREE_H
+
+// Required include's
+#include <vector>
+using std::vector;
+#include <utility>
+using std::pair;
+
+// Forward Declarations
+class State;
+class IterativeTree;
+struct IterativeTreeStats;
+
+// Used for tracking search statistics
+struct LDSTreeStats : public IterativeTreeStats
+{
+    LDSTreeStats();
+    virtual ~LDSTreeStats();
+    virtual void print() const;
+
+    // Variables for LDSTreeStats
+    int finalDiscrepancyLimit;
+};
+
+// Depth-first search that trusts the order in which branch() creates the
+// children: the child a DFSTree would explore first (the last one passed to
+// processState) follows the heuristic, and every other child costs one
+// discrepancy.  An iteration only stores states reached with at most the
+// current number of discrepancies; once it is done, the search restarts
+// from a copy of the root with <discrepancyStep> more allowed, until nothing
+// is cut off.  The memory used is that of a DFS, and good solutions are
+// found early when the branching order is a good heuristic.
+//
+// Children must be passed to the tree while their parent is branched on, so
+// bounding threads cannot be used.  See IterativeTree for the restrictions
+// that come with the restarts.
+class LDSTree : public IterativeTree
+{
+  public:
+    // Class functions unique to LDSTree
+    LDSTree(int probType, bool isIntProb, int step = 1);
+    virtual ~LDSTree();
+
+  protected:
+    // Variables
+    vector<pair<State *, int> > unexploredStates; // States and discrepancies
+    vector<State *> newChildren; // Children of the state being explored
+    State *lastState; // State being explored and its discrepancies
+    int lastDiscrepancies;
+    int discrepancyLimit;
+    int discrepancyStep;
+
+    // For tracking LDS search statistics
+    LDSTreeStats *ldsStats;
+
+    // Abstract class functions inherited from BTree that will be implemented
+    virtual bool isEmpty() const;
+    virtual State *getNextState();
+    virtual void saveStateForExploration(State *s);
+    virtual void exploreNextState();
+
+    // Class functions specific to LDSTree
+    void startNextIteration();
+
+  private:
+    // Nothing
+};
+
+/*****************************************************************************/
+/* LDSTree inline function definitions                                       */
+/*****************************************************************************/
+inline bool LDSTree::isEmpty() const
+{
+    return unexploredStates.empty() && !nextIterationReady();
+}
+
+#endif // LDSTREE_H
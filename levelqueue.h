@@ -0,0 +1,78 @@
+/*****************************************************************************/
+/* File: levelqueue.h                                                        */
+/* Description:                                                              */
+/*   Contains the design details for a priority queue of states that can     */
+/*   also be accessed by rank.                                               */
+/*****************************************************************************/
+#ifndef LEVELQUEUE_H
+#define LEVELQUEUE_H
+
+// Required include's
+#include <cstddef>
+#include <utility>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+#include "state.h"
+
+// Priority queue of states kept in an order-statistic tree, so that besides
+// the usual top/pop it can find or remove the state of any rank (0 being the
+// best) in O(log n).  States are ordered by State::operator< like in
+// state_priority_queue, with ties going to the state that was pushed first.
+// As with the heap, a state's order must not change while it is stored.
+class LevelQueue
+{
+  public:
+    LevelQueue() : nextSeq(0) {}
+
+    bool empty() const { return states.empty(); }
+    size_t size() const { return states.size(); }
+
+    void push(State *s) { states.insert(Entry(s, nextSeq++)); }
+    template <typename InputIt>
+    void push(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first) push(*first);
+    }
+
+    State *top() const { return states.begin()->first; }
+    void pop() { states.erase(states.begin()); }
+
+    State *at(size_t rank) const { return states.find_by_order(rank)->first; }
+    State *removeAt(size_t rank);
+
+  private:
+    typedef std::pair<State*, long long> Entry;
+    struct EntryOrder
+    {
+        bool operator()(const Entry& x, const Entry& y) const;
+    };
+    typedef __gnu_pbds::tree<Entry, __gnu_pbds::null_type, EntryOrder,
+                             __gnu_pbds::rb_tree_tag,
+                             __gnu_pbds::tree_order_statistics_node_update> entry_tree;
+
+    entry_tree states;
+    long long nextSeq;
+};
+
+/*****************************************************************************/
+/* LevelQueue inline function definitions                                    */
+/*****************************************************************************/
+inline State *LevelQueue::removeAt(size_t rank)
+{
+    entry_tree::iterator it = states.find_by_order(rank);
+    State *s = it->first;
+    states.erase(it);
+    return s;
+}
+
+// StateComparator orders the worst state first (as needed for a max-heap),
+// so better states are the ones it places after
+inline bool LevelQueue::EntryOrder::operator()(const Entry& x, const Entry& y) const
+{
+    if (StateComparator()(y.first, x.first)) return true;
+    if (StateComparator()(x.first, y.first)) return false;
+    return x.second < y.second;
+}
+
+#endif // LEVELQUEUE_H
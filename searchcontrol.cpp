@@ -0,0 +1,91 @@
+/*****************************************************************************/
+/* File: searchcontrol.cpp                                                   */
+/* Description:                                                              */
+/*   Contains the implementation details for the search control handle.     */
+/*****************************************************************************/
+#include "state.h"
+#include "searchcontrol.h"
+
+#include <limits>
+
+/*****************************************************************************/
+/* SearchControl constructor and destructor                                  */
+/*****************************************************************************/
+SearchControl::SearchControl() :
+    pending(false),
+    stopRequested(false),
+    paused(false),
+    nodeLimit(0),
+    timeLimit(0.0),
+    lowerBound(-std::numeric_limits<double>::max()),
+    upperBound(std::numeric_limits<double>::max())
+{
+    /* Do nothing */
+}
+
+SearchControl::~SearchControl()
+{
+    // Solutions submitted after the search ended were never merged
+    for (int i = 0; i < solutions.size(); ++i)
+        delete solutions[i];
+}
+
+/*****************************************************************************/
+/* SearchControl request functions                                           */
+/*****************************************************************************/
+void SearchControl::requestStop()
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    stopRequested = true;
+    pending = true;
+    resumed.notify_all();
+}
+
+void SearchControl::pause()
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    paused = true;
+    pending = true;
+}
+
+void SearchControl::resume()
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    paused = false;
+    resumed.notify_all();
+}
+
+void SearchControl::limitNodes(long long maxExplored)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if ((nodeLimit == 0) || (maxExplored < nodeLimit)) nodeLimit = maxExplored;
+    pending = true;
+}
+
+void SearchControl::limitTime(double seconds)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if ((timeLimit == 0) || (seconds < timeLimit)) timeLimit = seconds;
+    pending = true;
+}
+
+void SearchControl::offerLowerBound(double lb)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (lb > lowerBound) lowerBound = lb;
+    pending = true;
+}
+
+void SearchControl::offerUpperBound(double ub)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (ub < upperBound) upperBound = ub;
+    pending = true;
+}
+
+void SearchControl::submitSolution(State *s)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    solutions.push_back(s);
+    pending = true;
+}
@@ -0,0 +1,74 @@
+/*****************************************************************************/
+/* File: searchcontrol.h                                                     */
+/* Description:                                                              */
+/*   Contains the design details for a thread-safe handle used to steer a    */
+/*   running search from other threads.                                      */
+/*****************************************************************************/
+#ifndef SEARCHCONTROL_H
+#define SEARCHCONTROL_H
+
+// Required include's
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+using std::vector;
+
+// Forward Declarations
+class BTree;
+class State;
+
+// Obtained from BTree::getControl().  Any thread may call these functions at
+// any time; the requests are picked up by explore() between two explored 
+// states (a state that is being branched on is always finished first).
+class SearchControl
+{
+  public:
+    SearchControl();
+    ~SearchControl();
+
+    // Ends the search as if a limit had been reached
+    void requestStop();
+
+    // Blocks the search until resume() (or requestStop()) is called
+    void pause();
+    void resume();
+
+    // Lower the node limit (on explored states) or the CPU time limit (in 
+    // seconds, as BTree::setTimeLimit).  Limits are only ever tightened.
+    void limitNodes(long long maxExplored);
+    void limitTime(double seconds);
+
+    // Offer bounds found elsewhere (e.g. by another solver).  A bound only 
+    // replaces the tree's global bound if it is tighter; for a MIN problem 
+    // an upper bound is a new incumbent value, and vice versa for MAX.
+    void offerLowerBound(double lb);
+    void offerUpperBound(double ub);
+
+    // Hands a candidate solution found by another thread (e.g. a local 
+    // search or rounding heuristic) to the tree, which takes ownership of it.
+    // States that are not terminal are rejected; the others are merged like 
+    // BTree::processHeuristicState() and can immediately tighten pruning.
+    void submitSolution(State *s);
+
+    // Cheap check, used by the tree, for requests waiting to be applied
+    bool hasRequests() const { return pending.load(std::memory_order_acquire); }
+
+  private:
+    friend class BTree;
+
+    std::atomic<bool> pending;
+    std::mutex controlMutex;
+    std::condition_variable resumed;
+
+    // Requests not yet applied (guarded by controlMutex)
+    bool stopRequested;
+    bool paused;
+    long long nodeLimit; // 0 if no new limit
+    double timeLimit; // 0 if no new limit
+    double lowerBound;
+    double upperBound;
+    vector<State*> solutions;
+};
+
+#endif // SEARCHCONTROL_H
@@ -12,11 +12,34 @@
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <cstdint>
 
 // Forward Declarations
 class BTree;
 const double inf = std::numeric_limits<double>::max();
 
+// Compact summary of an explored state holding just what is needed to decide
+// whether it dominates other states.  When the tree releases explored states 
+// (BTree::setReleaseExplored), it keeps a signature in the dominance memory 
+// in place of the full state.
+class DomSignature
+{
+  public:
+	friend class BTree;
+    DomSignature() : lowerBound(-inf), upperBound(inf) {}
+    virtual ~DomSignature() {}
+
+    double getLB() const { return lowerBound; }
+    double getUB() const { return upperBound; }
+
+    // Bytes held by the signature, for memory accounting
+    virtual size_t memoryUsage() const { return sizeof(DomSignature); }
+
+  protected:
+    double lowerBound; // Copied from the state by the tree
+    double upperBound;
+};
+
 class State
 {
   public:
@@ -33,7 +56,13 @@ class State
 		upperBound(inf), 
 		//priority(-lowerBound), 
         dominated(false), 
-		processed(false) 
+		processed(false),
+		boundsDeferred(false),
+		releasePending(false),
+		numDeltaChildren(0),
+		deltaParent(NULL),
+		frontierBound(0.0),
+		boundIndexed(false)
 	{}
     virtual ~State() {}; // Declaration and definition of destructor
 	virtual State* clone() = 0; // "copy constructor"
@@ -50,25 +79,55 @@ class State
     virtual void print() const;
 	virtual void writeTulipOutput(FILE* tulipOutputFile) const { return; }
 
+    // Used when the tree releases explored states: createDomSignature() 
+    // returns a compact summary of this state (or NULL to keep the full 
+    // state), and assessSignatureDominance() marks this state as dominated if
+    // the explored state summarized by sig dominates it.
+    virtual DomSignature* createDomSignature() const { return NULL; }
+    virtual void assessSignatureDominance(const DomSignature *sig) { return; }
+
+    // Used when the tree stores states delta-encoded from their parents 
+    // (BTree::setDeltaEncoding): compact() discards everything that can be 
+    // rebuilt from the parent and the branching decision that produced this 
+    // state, keeping what operator<, assessDominance and the bounds need, and
+    // returns false if the state cannot be compacted.  materialize() rebuilds 
+    // the full state from its (explored, fully materialized) parent.
+    virtual bool compact() { return false; }
+    virtual void materialize(const State *parent) { return; }
+
+    // Used by the tree's transposition table to detect duplicate states. 
+    // Equivalent states must have the same hash key; isEquivalent() should 
+    // return true when this state cannot lead to a better solution than 
+    // other (e.g. same subproblem reached with no better cost).  A key of 0 
+    // means hashKey() was not overridden, and the table refuses it.
+    virtual uint64_t hashKey() const { return 0; }
+    virtual bool isEquivalent(const State *other) const { return false; }
+
+    // Used by the tree's memory accounting: the number of bytes held by this 
+    // state, including any heap storage it owns.  The default only counts 
+    // the base class, so subclasses should override it to get useful totals.
+    virtual size_t memoryUsage() const { return sizeof(State); }
+
     // Implemented class functions that cannot be overridden by subclasses
     int getDepth() const;
     int getDomClassID() const;
     double getObjValue() const;
     double getLB() const;
     double getUB() const;
-	int getID() const { return id; }
-	int getParentID() const { return parID; }
-	void setID(int i) { id = i; }
+	long long getID() const { return id; }
+	long long getParentID() const { return parID; }
+	void setID(long long i) { id = i; }
     bool isDominated() const;
     bool wasProcessed() const;
+    bool hasDeferredBounds() const { return boundsDeferred; }
 
 	virtual bool operator<(const State& other) = 0;
 
   protected:
     // Variables
-	int id, parID;
+	long long id, parID;
     int depth;
-	int timeToExplore;
+	long long timeToExplore;
     int dominanceClassID;
     double objValue;
     double lowerBound;
@@ -76,6 +135,12 @@ class State
     //double priority;
     bool dominated;
     bool processed;
+    bool boundsDeferred; // Bounds inherited from parent; computeBounds() pending
+    bool releasePending; // Explored, but compacted children still need it
+    int numDeltaChildren; // Number of compacted children referring to this state
+    State *deltaParent; // Parent to materialize from, if compacted
+    double frontierBound; // Bound under which the tree indexed this state
+    bool boundIndexed; // Whether frontierBound is in the tree's bound index
 };
 
 struct StateComparator
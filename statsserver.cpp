@@ -0,0 +1,108 @@
+/*****************************************************************************/
+/* File: statsserver.cpp                                                     */
+/* Description:                                                              */
+/*   Contains the implementation details for the Unix socket stats server.  */
+/*****************************************************************************/
+#include "statsserver.h"
+#include "util.h"
+
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
+
+// How often (in ms) the server thread checks whether it should shut down
+const int STATS_POLL_INTERVAL = 200;
+
+// Returns true if path names a socket (e.g. one left behind by an earlier
+// search), which may then be removed
+static bool isSocket(const string &path)
+{
+    struct stat info;
+    return (lstat(path.c_str(), &info) == 0) && S_ISSOCK(info.st_mode);
+}
+
+/*****************************************************************************/
+/* StatsServer constructor and destructor                                    */
+/*****************************************************************************/
+StatsServer::StatsServer(const char *socketPath) :
+    path(socketPath),
+    listenFD(-1),
+    stopping(false),
+    snapshot("{}\n")
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw ERROR << "Stats socket path is too long: " << path;
+    strcpy(addr.sun_path, path.c_str());
+
+    listenFD = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFD < 0)
+        throw ERROR << "Could not create stats socket: " << strerror(errno);
+    if (isSocket(path)) unlink(path.c_str());
+    if ((bind(listenFD, (sockaddr *) &addr, sizeof(addr)) < 0) || 
+        (listen(listenFD, 8) < 0))
+    {
+        string reason = strerror(errno);
+        close(listenFD);
+        throw ERROR << "Could not listen on stats socket " << path << ": " << reason;
+    }
+
+    server = std::thread(&StatsServer::serverLoop, this);
+}
+
+StatsServer::~StatsServer()
+{
+    stopping = true;
+    server.join();
+    close(listenFD);
+    if (isSocket(path)) unlink(path.c_str());
+}
+
+/*****************************************************************************/
+/* StatsServer functions                                                     */
+/*****************************************************************************/
+bool StatsServer::tryPublish(string &newSnapshot)
+{
+    std::unique_lock<std::mutex> lock(snapshotMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return false;
+    snapshot.swap(newSnapshot);
+    return true;
+}
+
+void StatsServer::serverLoop()
+{
+    pollfd pfd;
+    pfd.fd = listenFD;
+    pfd.events = POLLIN;
+
+    string reply;
+    while (!stopping)
+    {
+        if (poll(&pfd, 1, STATS_POLL_INTERVAL) <= 0) continue;
+        int clientFD = accept(listenFD, NULL, NULL);
+        if (clientFD < 0) continue;
+
+        // Copy the snapshot so that the search is only locked out briefly, 
+        // and never while waiting on the client
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            reply = snapshot;
+        }
+        size_t sent = 0;
+        while (sent < reply.size())
+        {
+            ssize_t n = send(clientFD, reply.data() + sent, reply.size() - sent, 
+                             MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += n;
+        }
+        close(clientFD);
+    }
+    return;
+}
@@ -0,0 +1,48 @@
+/*****************************************************************************/
+/* File: statsserver.h                                                       */
+/* Description:                                                              */
+/*   Contains the design details for a small server that answers queries    */
+/*   about a running search over a local Unix domain socket.                 */
+/*****************************************************************************/
+#ifndef STATSSERVER_H
+#define STATSSERVER_H
+
+// Required include's
+#include <string>
+using std::string;
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+// Every client that connects to the socket is sent the latest published 
+// snapshot (a JSON object) and disconnected, e.g. `socat - UNIX:<path>`.  The
+// search thread publishes snapshots without ever waiting for the server: if
+// a client is being served at that moment, the snapshot is simply skipped.
+class StatsServer
+{
+  public:
+    // Creates the socket at <socketPath> (replacing a stale socket there, 
+    // but never any other kind of file) and starts serving it; throws an 
+    // Error if that fails
+    StatsServer(const char *socketPath);
+    ~StatsServer();
+
+    // Replaces the snapshot served to clients, unless the server is busy 
+    // reading it.  Returns true if the snapshot was published.
+    bool tryPublish(string &snapshot);
+
+    const string &getPath() const { return path; }
+
+  private:
+    string path;
+    int listenFD;
+    std::thread server;
+    std::atomic<bool> stopping;
+
+    std::mutex snapshotMutex;
+    string snapshot;
+
+    void serverLoop();
+};
+
+#endif // STATSSERVER_H
@@ -0,0 +1,77 @@
+/*****************************************************************************/
+/* File: threadpool.cpp                                                      */
+/* Description:                                                              */
+/*   Contains the implementation details for a simple fixed-size thread pool.*/
+/*****************************************************************************/
+#include "threadpool.h"
+
+/*****************************************************************************/
+/* ThreadPool constructor and destructor                                     */
+/*****************************************************************************/
+ThreadPool::ThreadPool(int numThreads) :
+    numActive(0),
+    stopping(false)
+{
+    for (int i = 0; i < numThreads; ++i)
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+    // Let the workers finish whatever is still queued, then join them
+    {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (int i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+/*****************************************************************************/
+/* ThreadPool task functions                                                 */
+/*****************************************************************************/
+void ThreadPool::submit(const std::function<void()>& task)
+{
+    {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        tasks.push(task);
+    }
+    taskAvailable.notify_one();
+    return;
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (!tasks.empty() || numActive > 0)
+        tasksFinished.wait(lock);
+    return;
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            while (tasks.empty() && !stopping)
+                taskAvailable.wait(lock);
+            if (tasks.empty()) return; // Stopping and nothing left to do
+
+            task = tasks.front();
+            tasks.pop();
+            ++numActive;
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            --numActive;
+            if (tasks.empty() && numActive == 0) tasksFinished.notify_all();
+        }
+    }
+}
+
@@ -0,0 +1,48 @@
+/*****************************************************************************/
+/* File: threadpool.h                                                        */
+/* Description:                                                              */
+/*   Contains the design details for a simple fixed-size thread pool used to */
+/*   offload work (e.g. bound computations) from the search thread.          */
+/*****************************************************************************/
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Required include's
+#include <vector>
+using std::vector;
+#include <queue>
+using std::queue;
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ThreadPool
+{
+  public:
+    ThreadPool(int numThreads);
+    ~ThreadPool();
+
+    // Queues a task to be run by one of the worker threads
+    void submit(const std::function<void()>& task);
+
+    // Blocks until every submitted task has finished running
+    void wait();
+
+    int size() const { return workers.size(); }
+
+  private:
+    vector<std::thread> workers;
+    queue<std::function<void()> > tasks;
+
+    std::mutex poolMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable tasksFinished;
+    int numActive;
+    bool stopping;
+
+    void workerLoop();
+};
+
+#endif // THREADPOOL_H
+
@@ -0,0 +1,70 @@
+/*****************************************************************************/
+/* File: transtable.cpp                                                      */
+/* Description:                                                              */
+/*   Contains the implementation details for a hashed transposition table.   */
+/*****************************************************************************/
+#include "state.h"
+#include "transtable.h"
+#include "util.h"
+
+/*****************************************************************************/
+/* TranspositionTable constructor and destructor                             */
+/*****************************************************************************/
+TranspositionTable::TranspositionTable(size_t maxEntries) :
+    clock(0)
+{
+    // Use a power of two number of buckets so that a mask selects the bucket;
+    // round down so that the table never holds more than maxEntries states
+    size_t numBuckets = 1;
+    while (numBuckets * 2 * TT_BUCKET_SIZE <= maxEntries) numBuckets *= 2;
+    bucketMask = numBuckets - 1;
+
+    Entry empty = { 0, NULL, 0 };
+    entries.assign(numBuckets * TT_BUCKET_SIZE, empty);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    for (size_t i = 0; i < entries.size(); ++i)
+        delete entries[i].state;
+}
+
+/*****************************************************************************/
+/* TranspositionTable lookup functions                                       */
+/*****************************************************************************/
+int TranspositionTable::lookup(State *s)
+{
+    uint64_t hash = s->hashKey();
+    if (hash == 0)
+        throw ERROR << "States must override State::hashKey() with a nonzero key to use the transposition table.";
+    // Mix the hash so that weak user hashes still spread over the buckets
+    uint64_t mixed = hash * 0x9E3779B97F4A7C15ULL;
+    Entry *bucket = &entries[((mixed >> 32) & bucketMask) * TT_BUCKET_SIZE];
+    ++clock;
+
+    Entry *victim = NULL;
+    for (int i = 0; i < TT_BUCKET_SIZE; ++i)
+    {
+        Entry &e = bucket[i];
+        if (e.state == NULL) 
+        {
+            if ((victim == NULL) || (victim->state != NULL)) victim = &e;
+            continue;
+        }
+        if ((e.hash == hash) && s->isEquivalent(e.state))
+        {
+            e.lastUsed = clock;
+            return TT_HIT;
+        }
+        if ((victim == NULL) || ((victim->state != NULL) && (e.lastUsed < victim->lastUsed)))
+            victim = &e;
+    }
+
+    int result = (victim->state == NULL) ? TT_INSERTED : TT_REPLACED;
+    delete victim->state;
+    victim->hash = hash;
+    victim->state = s->clone();
+    victim->lastUsed = clock;
+    return result;
+}
+
@@ -0,0 +1,59 @@
+/*****************************************************************************/
+/* File: transtable.h                                                        */
+/* Description:                                                              */
+/*   Contains the design details for a fixed-size hashed transposition table */
+/*   used to detect states that have already been seen in the tree.          */
+/*****************************************************************************/
+#ifndef TRANSTABLE_H
+#define TRANSTABLE_H
+
+// Required include's
+#include <vector>
+using std::vector;
+#include <cstdint>
+#include <cstddef>
+
+// Forward Declarations
+class State;
+
+// Results of a transposition table lookup
+const int TT_HIT = 0;      // An equivalent state was seen before
+const int TT_INSERTED = 1; // New state stored in a free slot
+const int TT_REPLACED = 2; // New state stored by evicting an older entry
+
+// The table is set-associative: a state's hash selects a bucket of 
+// TT_BUCKET_SIZE entries, and when the bucket is full the least recently 
+// used entry is replaced, so memory never exceeds the configured capacity.
+// The number of buckets is the largest power of two that fits in the 
+// capacity (with a minimum of one bucket), so up to half of the requested 
+// entries may go unused.
+// Entries hold their own copies of the states.
+const int TT_BUCKET_SIZE = 4;
+
+class TranspositionTable
+{
+  public:
+    TranspositionTable(size_t maxEntries);
+    ~TranspositionTable();
+
+    // Checks whether a state equivalent to s has been seen; if not, records a
+    // copy of s.  Returns one of TT_HIT, TT_INSERTED or TT_REPLACED.
+    int lookup(State *s);
+
+    size_t capacity() const { return entries.size(); }
+
+  private:
+    struct Entry
+    {
+        uint64_t hash;
+        State *state;
+        uint64_t lastUsed;
+    };
+
+    vector<Entry> entries;
+    size_t bucketMask;
+    uint64_t clock;
+};
+
+#endif // TRANSTABLE_H
+
@@ -0,0 +1,210 @@
+/*****************************************************************************/
+/* File: undodfstree.cpp                                                     */
+/* Description:                                                              */
+/*   Contains the implementation details for an in-place DFS branching tree  */
+/*   class that applies and undoes branching decisions.                      */
+/*****************************************************************************/
+#include "state.h"
+#include "btree.h"
+#include "undodfstree.h"
+#include "util.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/*****************************************************************************/
+/* UndoDFSTree constructor, destructor, and initialization functions         */
+/*****************************************************************************/
+UndoDFSTree::UndoDFSTree(int probType, bool isIntProb) :
+	BTree(probType, isIntProb),
+	state(NULL),
+	rootExplored(false),
+	numFrames(0)
+{
+	name = "*** In-place DFS ***";
+    undoStats = new UndoDFSTreeStats();
+    tStats = undoStats; // Make tStats pointer point to undoStats
+
+    // The single state is owned by this tree, never by the dominance memory
+    retainStates = false;
+}
+
+UndoDFSTree::~UndoDFSTree()
+{
+    // Calls BTree destructor by default
+    if (!retainStates) delete state;
+}
+
+/*****************************************************************************/
+/* UndoDFSTree search functions                                              */
+/*****************************************************************************/
+State *UndoDFSTree::getNextState()
+{
+    // States are never removed from this tree; there is only the one
+    return state;
+}
+
+void UndoDFSTree::saveStateForExploration(State *s)
+{
+    ReversibleState *rs = dynamic_cast<ReversibleState *>(s);
+    if (rs == NULL)
+        throw ERROR << "UndoDFSTree requires the root to be a ReversibleState.";
+    if (state != NULL)
+        throw ERROR << "UndoDFSTree only stores the root state.";
+    if (retainStates)
+        throw ERROR << "UndoDFSTree cannot retain states; it owns its only state.";
+    state = rs;
+    return;
+}
+
+void UndoDFSTree::exploreNextState()
+{
+    // Explore the root first
+    if (!rootExplored)
+    {
+        rootExplored = true;
+        removeLiveState(state);
+        if (stateIsPrunable(state)) return;
+
+        Frame saved;
+        saveFields(saved);
+        pushFrame(0, saved);
+        return;
+    }
+
+    // Then try the remaining decisions on the current path, deepest first, 
+    // until a child survives to be explored
+    while (numFrames > 0)
+    {
+        Frame &f = frames[numFrames - 1];
+        if (f.next == f.decisions.size())
+        {
+            popFrame();
+            continue;
+        }
+
+        Decision d = f.decisions[f.next++];
+        Frame saved;
+        saveFields(saved);
+        state->applyDecision(d);
+        state->depth = saved.depth + 1;
+        state->dominated = false;
+
+        while (state->depth >= tStats->numIdentifiedAtLevel.size()) 
+            tStats->numIdentifiedAtLevel.push_back(0);
+        ++tStats->numIdentifiedAtLevel[state->depth];
+        ++tStats->statesIdentified;
+
+        if (state->isTerminalState())
+        {
+            ++tStats->terminalStatesIdentified;
+            saveBestState(state, true);
+        }
+        else
+        {
+            if (!stateComputesBounds) 
+                state->computeBounds(this);
+            if (!stateExceedsBounds(state))
+            {
+                pushFrame(d, saved);
+                return;
+            }
+            ++tStats->statesPrunedByBoundsBeforeInsertion;
+        }
+
+        state->undoDecision(d);
+        restoreFields(saved);
+    }
+    return;
+}
+
+// Explores the state in its current position: counts it and lists its 
+// decisions in a new frame (which also remembers how to undo <applied>)
+void UndoDFSTree::pushFrame(Decision applied, const Frame &saved)
+{
+    // The root was already counted as stored by processState()
+    if (numFrames > 0)
+    {
+        while (state->depth >= tStats->numStoredAtLevel.size()) 
+            tStats->numStoredAtLevel.push_back(0);
+        ++tStats->numStoredAtLevel[state->depth];
+        ++tStats->statesStoredInTree;
+    }
+
+    while (state->depth >= tStats->numExploredAtLevel.size()) 
+        tStats->numExploredAtLevel.push_back(0);
+    ++tStats->numExploredAtLevel[state->depth];
+    ++tStats->statesExplored;
+    if (state->depth > undoStats->maxDepthReached) 
+        undoStats->maxDepthReached = state->depth;
+
+    if (numFrames == frames.size()) frames.push_back(Frame());
+    Frame &f = frames[numFrames++];
+    f.depth = saved.depth;
+    f.objValue = saved.objValue;
+    f.lowerBound = saved.lowerBound;
+    f.upperBound = saved.upperBound;
+    f.dominated = saved.dominated;
+    f.applied = applied;
+    f.next = 0;
+    f.decisions.clear();
+    state->getDecisions(f.decisions);
+    return;
+}
+
+void UndoDFSTree::popFrame()
+{
+    // Turn the state back into its parent (the root has nothing to undo)
+    Frame &f = frames[--numFrames];
+    if (numFrames > 0)
+    {
+        state->undoDecision(f.applied);
+        restoreFields(f);
+    }
+    return;
+}
+
+void UndoDFSTree::saveFields(Frame &f) const
+{
+    f.depth = state->depth;
+    f.objValue = state->objValue;
+    f.lowerBound = state->lowerBound;
+    f.upperBound = state->upperBound;
+    f.dominated = state->dominated;
+    return;
+}
+
+void UndoDFSTree::restoreFields(const Frame &f)
+{
+    state->depth = f.depth;
+    state->objValue = f.objValue;
+    state->lowerBound = f.lowerBound;
+    state->upperBound = f.upperBound;
+    state->dominated = f.dominated;
+    return;
+}
+
+/*****************************************************************************/
+/* UndoDFSTreeStats function definitions                                     */
+/*****************************************************************************/
+UndoDFSTreeStats::UndoDFSTreeStats()
+{
+    // Calls TreeStats constructor by default
+    maxDepthReached = 0;
+}
+
+UndoDFSTreeStats::~UndoDFSTreeStats()
+{
+    // Calls TreeStats destructor by default
+    // Clean-up
+}
+
+void UndoDFSTreeStats::print() const
+{
+    TreeStats::print();
+    // Put extra UndoDFSTree printing here
+    printf("Printing In-place DFS Tree Stats\n");
+    printf("Maximum depth reached: %d\n", maxDepthReached);
+    return;
+}
+
@@ -0,0 +1,117 @@
+/*****************************************************************************/
+/* File: undodfstree.h                                                       */
+/* Description:                                                              */
+/*   Contains the design details for an in-place DFS branching tree class    */
+/*   that applies and undoes branching decisions on a single mutable state.  */
+/*****************************************************************************/
+#ifndef UNDODFSTREE_H
+#define UNDODFSTREE_H
+
+// Required include's
+#include <vector>
+using std::vector;
+
+// Forward Declarations
+class State;
+class BTree;
+struct TreeStats;
+
+// A branching decision; its meaning is entirely up to the state (e.g. an 
+// index into its list of candidate moves or an encoded variable/value pair)
+typedef long Decision;
+
+// A state that can be turned into any of its children and back again, so that
+// a depth-first search never needs to allocate or clone states.  The tree 
+// itself saves and restores the depth, objective value, bounds and dominance 
+// flag around each decision.
+class ReversibleState : public State
+{
+  public:
+    // Appends the decisions leading to this state's children, in the order 
+    // they should be explored
+    virtual void getDecisions(vector<Decision>& decisions) = 0;
+
+    // Turns this state into the child reached by d, and back into its parent
+    virtual void applyDecision(Decision d) = 0;
+    virtual void undoDecision(Decision d) = 0;
+
+    // Children are never created explicitly
+    virtual void branch(BTree *bt) { return; }
+
+  private:
+    friend class UndoDFSTree;
+};
+
+// Used for tracking search statistics
+struct UndoDFSTreeStats : public TreeStats
+{
+    UndoDFSTreeStats();
+    virtual ~UndoDFSTreeStats();
+    virtual void print() const;
+
+    // Variables for UndoDFSTreeStats
+    int maxDepthReached;
+};
+
+// Pass the root (a ReversibleState) to processState() as usual and call 
+// explore().  States are never stored, so dominance rules, the transposition 
+// table and the other state storage options do not apply to this tree 
+// (setRetainStates(true) is rejected); clone() is only used to save new 
+// incumbents.
+class UndoDFSTree : public BTree
+{
+  public:
+    // Class functions unique to UndoDFSTree
+    UndoDFSTree(int probType, bool isIntProb);
+    virtual ~UndoDFSTree();
+
+  protected:
+    // One level of the search path: the decisions available at the state at 
+    // this depth, and what is needed to undo the decision that reached it
+    struct Frame
+    {
+        vector<Decision> decisions;
+        size_t next;
+        Decision applied;
+        int depth;
+        double objValue;
+        double lowerBound;
+        double upperBound;
+        bool dominated;
+    };
+
+    // Variables
+    ReversibleState *state;
+    bool rootExplored;
+    vector<Frame> frames; // Frames are reused to keep their decision buffers
+    int numFrames;
+
+    // For tracking in-place DFS search statistics 
+    UndoDFSTreeStats *undoStats;
+
+    // Abstract class functions inherited from BTree that will be implemented
+    virtual bool isEmpty() const;
+    virtual State *getNextState();
+    virtual void saveStateForExploration(State *s);
+    virtual void exploreNextState();
+
+    // Class functions specific to UndoDFSTree
+    void pushFrame(Decision applied, const Frame &saved);
+    void popFrame();
+    void saveFields(Frame &f) const;
+    void restoreFields(const Frame &f);
+
+  private:
+    // Nothing
+};
+
+/*****************************************************************************/
+/* UndoDFSTree inline function definitions                                   */
+/*****************************************************************************/
+inline bool UndoDFSTree::isEmpty() const
+{
+    return (state == NULL) || (rootExplored && (numFrames == 0));
+}
+
+#endif // UNDODFSTREE_H
+